@@ -68,22 +68,28 @@ static void runScript(VM* vm, const char* path, const char* script) {
 }
 
 int main(int argc, char* argv[]) {
+    int optionCount = 0;
+    while (optionCount + 1 < argc && strncmp(argv[optionCount + 1], "--", 2) == 0) {
+        optionCount++;
+    }
+
     VM vm;
-    initVM(&vm);
+    initVM(&vm, optionCount, argv + 1);
     runAtStartup();
     atexit(runAtExit);
 
+    int argCount = argc - optionCount;
     if (strlen(vm.config.script) > 0) {
         runScript(&vm, vm.config.path, vm.config.script);
     }
-    else if (argc == 1) {
+    else if (argCount == 1) {
         repl(&vm);
     } 
-    else if (argc == 2) {
-        runFile(&vm, argv[1]);
+    else if (argCount == 2) {
+        runFile(&vm, argv[optionCount + 1]);
     } 
     else {
-        fprintf(stderr, "Usage: lox2 [path]\n");
+        fprintf(stderr, "Usage: lox2 [--section.name=value]... [path]\n");
         exit(64);
     }
   
@@ -7,6 +7,10 @@
 #include <stdint.h>
 
 #define NAN_BOXING
+#if defined(__GNUC__) || defined(__clang__)
+#define COMPUTED_GOTO
+#endif
+
 //#define DEBUG_TRACE_EXECUTION
 //#define DEBUG_PRINT_SHAPE
 //#define DEBUG_TRACE_CACHE
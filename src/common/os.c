@@ -57,8 +57,6 @@ void runAtStartup() {
     SetConsoleCP(CP_UTF8);
     SetConsoleOutputCP(CP_UTF8);
 #endif
-
-    curl_global_init(CURL_GLOBAL_ALL);
 }
 
 void runAtExit(void) {
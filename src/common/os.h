@@ -7,6 +7,7 @@
 #ifdef _WIN32
 #include <direct.h>
 #include <io.h>
+#include <malloc.h>
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #else
@@ -23,6 +24,8 @@
 #define sprintf_s(buffer,bufsz,format,...) sprintf(buffer,format,__VA_ARGS__)
 #define snprintf_s(buffer,bufsz,format,...) snprintf(buffer,format,__VA_ARGS__)
 #define strtok_s(str,delim,ctx) strtok(str,delim)
+#define _aligned_free(pointer) free(pointer)
+#define _aligned_malloc(size,alignment) aligned_alloc(alignment,size)
 #define _chmod(path,mode) chmod(path,mode)
 #define _getcwd(buffer,size) getcwd(buffer,size)
 #define _mkdir(path) mkdir(path,777)
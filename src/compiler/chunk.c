@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "chunk.h"
 #include "../vm/memory.h"
@@ -9,16 +10,28 @@ void initChunk(Chunk* chunk, GCGenerationType generation) {
     chunk->capacity = 0;
     chunk->generation = generation;
     chunk->code = NULL;
+    chunk->lineCount = 0;
+    chunk->lineCapacity = 0;
     chunk->lines = NULL;
+    chunk->inlineCacheCount = 0;
+    chunk->inlineCacheCapacity = 0;
     chunk->inlineCaches = NULL;
+    chunk->deoptimizedSites = NULL;
+    chunk->handlerCount = 0;
+    chunk->handlerCapacity = 0;
+    chunk->handlers = NULL;
     initValueArray(&chunk->constants, generation);
     initValueArray(&chunk->identifiers, generation);
 }
 
 void freeChunk(VM* vm, Chunk* chunk) {
     FREE_ARRAY(uint8_t, chunk->code, chunk->capacity, chunk->generation);
-    FREE_ARRAY(int, chunk->lines, chunk->capacity, chunk->generation);
-    FREE_ARRAY(InlineCache, chunk->inlineCaches, chunk->identifiers.capacity, chunk->generation);
+    FREE_ARRAY(LineStart, chunk->lines, chunk->lineCapacity, chunk->generation);
+    FREE_ARRAY(InlineCache, chunk->inlineCaches, chunk->inlineCacheCapacity, chunk->generation);
+    if (chunk->deoptimizedSites != NULL) {
+        FREE_ARRAY(uint8_t, chunk->deoptimizedSites, DEOPTIMIZED_SITES_SIZE(chunk->count), GC_GENERATION_TYPE_PERMANENT);
+    }
+    FREE_ARRAY(ExceptionHandler, chunk->handlers, chunk->handlerCapacity, chunk->generation);
     freeValueArray(vm, &chunk->constants);
     freeValueArray(vm, &chunk->identifiers);
     initChunk(chunk, chunk->generation);
@@ -29,12 +42,21 @@ void writeChunk(VM* vm, Chunk* chunk, uint8_t byte, int line) {
         int oldCapacity = chunk->capacity;
         chunk->capacity = GROW_CAPACITY(oldCapacity);
         chunk->code = GROW_ARRAY(uint8_t, chunk->code, oldCapacity, chunk->capacity, chunk->generation);
-        chunk->lines = GROW_ARRAY(int, chunk->lines, oldCapacity, chunk->capacity, chunk->generation);
     }
     
     chunk->code[chunk->count] = byte;
-    chunk->lines[chunk->count] = line;
     chunk->count++;
+    if (chunk->lineCount > 0 && chunk->lines[chunk->lineCount - 1].line == line) return;
+
+    if (chunk->lineCapacity < chunk->lineCount + 1) {
+        int oldCapacity = chunk->lineCapacity;
+        chunk->lineCapacity = GROW_CAPACITY(oldCapacity);
+        chunk->lines = GROW_ARRAY(LineStart, chunk->lines, oldCapacity, chunk->lineCapacity, chunk->generation);
+    }
+
+    LineStart* lineStart = &chunk->lines[chunk->lineCount++];
+    lineStart->offset = chunk->count - 1;
+    lineStart->line = line;
 }
 
 int addConstant(VM* vm, Chunk* chunk, Value value) {
@@ -46,20 +68,59 @@ int addConstant(VM* vm, Chunk* chunk, Value value) {
 
 int addIdentifier(VM* vm, Chunk* chunk, Value value) {
     push(vm, value);
-    int oldCapacity = chunk->identifiers.capacity;
-    int oldCount = chunk->identifiers.count;
-
     valueArrayWrite(vm, &chunk->identifiers, value);
-    if (oldCapacity < chunk->identifiers.capacity) {
-        chunk->inlineCaches = GROW_ARRAY(InlineCache, chunk->inlineCaches, oldCapacity, chunk->identifiers.capacity, chunk->generation);
-    }
-    InlineCache inlineCache = { .type = CACHE_NONE, .id = 0, .index = 0 };
-    
-    chunk->inlineCaches[oldCount] = inlineCache;
     pop(vm);
     return chunk->identifiers.count - 1;
 }
 
+int addInlineCache(VM* vm, Chunk* chunk) {
+    if (chunk->inlineCacheCapacity < chunk->inlineCacheCount + 1) {
+        int oldCapacity = chunk->inlineCacheCapacity;
+        chunk->inlineCacheCapacity = GROW_CAPACITY(oldCapacity);
+        chunk->inlineCaches = GROW_ARRAY(InlineCache, chunk->inlineCaches, oldCapacity, chunk->inlineCacheCapacity, chunk->generation);
+    }
+
+    InlineCache inlineCache = { .count = 0, .missCount = 0, .isMegamorphic = false };
+    chunk->inlineCaches[chunk->inlineCacheCount] = inlineCache;
+    return chunk->inlineCacheCount++;
+}
+
+int addExceptionHandler(VM* vm, Chunk* chunk, int startAddress) {
+    if (chunk->handlerCapacity < chunk->handlerCount + 1) {
+        int oldCapacity = chunk->handlerCapacity;
+        chunk->handlerCapacity = GROW_CAPACITY(oldCapacity);
+        chunk->handlers = GROW_ARRAY(ExceptionHandler, chunk->handlers, oldCapacity, chunk->handlerCapacity, chunk->generation);
+    }
+
+    ExceptionHandler* handler = &chunk->handlers[chunk->handlerCount];
+    handler->startAddress = (uint16_t)startAddress;
+    handler->endAddress = (uint16_t)startAddress;
+    handler->handlerAddress = UINT16_MAX;
+    handler->finallyAddress = UINT16_MAX;
+    handler->exceptionType = 0;
+    return chunk->handlerCount++;
+}
+
+void markSiteDeoptimized(VM* vm, Chunk* chunk, int offset) {
+    if (chunk->deoptimizedSites == NULL) {
+        chunk->deoptimizedSites = ALLOCATE(uint8_t, DEOPTIMIZED_SITES_SIZE(chunk->count), GC_GENERATION_TYPE_PERMANENT);
+        memset(chunk->deoptimizedSites, 0, DEOPTIMIZED_SITES_SIZE(chunk->count));
+    }
+    chunk->deoptimizedSites[offset >> 3] |= (uint8_t)(1 << (offset & 7));
+}
+
+int getLine(Chunk* chunk, int instruction) {
+    int start = 0;
+    int end = chunk->lineCount - 1;
+
+    while (start < end) {
+        int mid = (start + end + 1) / 2;
+        if (chunk->lines[mid].offset <= instruction) start = mid;
+        else end = mid - 1;
+    }
+    return chunk->lineCount > 0 ? chunk->lines[start].line : 0;
+}
+
 int opCodeOffset(Chunk* chunk, int ip) {
     OpCode code = chunk->code[ip];
 
@@ -75,13 +136,13 @@ int opCodeOffset(Chunk* chunk, int ip) {
         case OP_SET_LOCAL: return 2;
         case OP_DEFINE_GLOBAL_VAL: return 2;
         case OP_DEFINE_GLOBAL_VAR: return 2;
-        case OP_GET_GLOBAL: return 2;
+        case OP_GET_GLOBAL: return 4;
         case OP_SET_GLOBAL: return 2;
         case OP_GET_UPVALUE: return 2;
         case OP_SET_UPVALUE: return 2;
-        case OP_GET_PROPERTY: return 2;
-        case OP_SET_PROPERTY: return 2;
-        case OP_GET_PROPERTY_OPTIONAL: return 2;
+        case OP_GET_PROPERTY: return 4;
+        case OP_SET_PROPERTY: return 4;
+        case OP_GET_PROPERTY_OPTIONAL: return 4;
         case OP_GET_SUBSCRIPT: return 1;
         case OP_SET_SUBSCRIPT: return 1;
         case OP_GET_SUBSCRIPT_OPTIONAL: return 1;
@@ -103,12 +164,12 @@ int opCodeOffset(Chunk* chunk, int ip) {
         case OP_LOOP: return 3;
         case OP_CALL: return 2;
         case OP_OPTIONAL_CALL: return 2;
-        case OP_INVOKE: return 3;
-        case OP_SUPER_INVOKE: return 3;
-        case OP_OPTIONAL_INVOKE: return 3;
+        case OP_INVOKE: return 5;
+        case OP_SUPER_INVOKE: return 5;
+        case OP_OPTIONAL_INVOKE: return 5;
         case OP_CLOSURE: {
-            int constant = (chunk->code[ip + 1] << 8) | chunk->code[ip + 2];
-            ObjFunction* function = AS_FUNCTION(chunk->constants.values[constant]);
+            uint8_t identifier = chunk->code[ip + 1];
+            ObjFunction* function = AS_FUNCTION(chunk->identifiers.values[identifier]);
             return 2 + (function->upvalueCount * 2);
         }
         case OP_CLOSE_UPVALUE: return 1;
@@ -128,14 +189,31 @@ int opCodeOffset(Chunk* chunk, int ip) {
         case OP_GET_NAMESPACE: return 2;
         case OP_USING_NAMESPACE: return 2;
         case OP_THROW: return 1;
-        case OP_TRY: return 6;
-        case OP_CATCH: return 1;
         case OP_FINALLY: return 1;
         case OP_RETURN: return 1;
         case OP_RETURN_NONLOCAL: return 2;
         case OP_YIELD: return 1;
         case OP_YIELD_FROM: return 1;
         case OP_AWAIT: return 1;
+        case OP_ADD_INT: return 1;
+        case OP_ADD_FLOAT: return 1;
+        case OP_ADD_STRING: return 1;
+        case OP_SUBTRACT_INT: return 1;
+        case OP_SUBTRACT_FLOAT: return 1;
+        case OP_GREATER_INT: return 1;
+        case OP_GREATER_FLOAT: return 1;
+        case OP_LESS_INT: return 1;
+        case OP_LESS_FLOAT: return 1;
+        case OP_EQUAL_INT: return 1;
+        case OP_GET_SUBSCRIPT_ARRAY_INT: return 1;
+        case OP_GET_LOCAL_LOCAL: return 3;
+        case OP_GET_LOCAL_PROPERTY: return 5;
+        case OP_POP_JUMP_IF_FALSE: return 3;
+        case OP_FOR_PREP: return 3;
+        case OP_FOR_ITER: return 6;
+        case OP_TO_STRING: return 5;
+        case OP_INTERPOLATE: return 2;
+        case OP_TAIL_CALL: return 2;
         case OP_END: return 1;
         default: return 0;
     }
@@ -64,14 +64,31 @@ typedef enum {
     OP_GET_NAMESPACE,
     OP_USING_NAMESPACE,
     OP_THROW,
-    OP_TRY,
-    OP_CATCH,
     OP_FINALLY,
     OP_RETURN,
     OP_RETURN_NONLOCAL,
     OP_YIELD,
     OP_YIELD_FROM,
     OP_AWAIT,
+    OP_ADD_INT,
+    OP_ADD_FLOAT,
+    OP_ADD_STRING,
+    OP_SUBTRACT_INT,
+    OP_SUBTRACT_FLOAT,
+    OP_GREATER_INT,
+    OP_GREATER_FLOAT,
+    OP_LESS_INT,
+    OP_LESS_FLOAT,
+    OP_EQUAL_INT,
+    OP_GET_SUBSCRIPT_ARRAY_INT,
+    OP_GET_LOCAL_LOCAL,
+    OP_GET_LOCAL_PROPERTY,
+    OP_POP_JUMP_IF_FALSE,
+    OP_FOR_PREP,
+    OP_FOR_ITER,
+    OP_TO_STRING,
+    OP_INTERPOLATE,
+    OP_TAIL_CALL,
     OP_END
 } OpCode;
 
@@ -81,24 +98,60 @@ typedef enum {
     CACHE_CVAR,
     CACHE_GVAL,
     CACHE_GVAR,
-    CACHE_METHOD
+    CACHE_METHOD,
+    CACHE_TRANSITION
 } InlineCacheType;
 
+#define INLINE_CACHE_SIZE 4
+#define INLINE_CACHE_RETRY_MISSES 64
+#define DEOPTIMIZED_SITES_SIZE(count) (((size_t)(count) + 7) / 8)
+
 typedef struct {
     InlineCacheType type;
     int id;
     int index;
+    int shapeID;
+    int version;
+    Value method;
+} InlineCacheEntry;
+
+typedef struct {
+    uint8_t count;
+    uint8_t missCount;
+    bool isMegamorphic;
+    InlineCacheEntry entries[INLINE_CACHE_SIZE];
 } InlineCache;
 
+typedef struct {
+    int offset;
+    int line;
+} LineStart;
+
+typedef struct {
+    uint16_t startAddress;
+    uint16_t endAddress;
+    uint16_t handlerAddress;
+    uint16_t finallyAddress;
+    uint8_t exceptionType;
+} ExceptionHandler;
+
 typedef struct {
     int count;
     int capacity;
     GCGenerationType generation;
     uint8_t* code;
-    int* lines;
+    int lineCount;
+    int lineCapacity;
+    LineStart* lines;
     ValueArray constants;
     ValueArray identifiers;
+    int inlineCacheCount;
+    int inlineCacheCapacity;
     InlineCache* inlineCaches;
+    uint8_t* deoptimizedSites;
+    int handlerCount;
+    int handlerCapacity;
+    ExceptionHandler* handlers;
 } Chunk;
 
 void initChunk(Chunk* chunk, GCGenerationType generation);
@@ -106,6 +159,10 @@ void freeChunk(VM* vm, Chunk* chunk);
 void writeChunk(VM* vm, Chunk* chunk, uint8_t byte, int line);
 int addConstant(VM* vm, Chunk* chunk, Value value);
 int addIdentifier(VM* vm, Chunk* chunk, Value value);
+int addInlineCache(VM* vm, Chunk* chunk);
+int addExceptionHandler(VM* vm, Chunk* chunk, int startAddress);
+void markSiteDeoptimized(VM* vm, Chunk* chunk, int offset);
+int getLine(Chunk* chunk, int instruction);
 int opCodeOffset(Chunk* chunk, int ip);
 
 static inline uint8_t firstOPCode(Chunk* chunk) {
@@ -116,10 +173,82 @@ static inline uint8_t lastOPCode(Chunk* chunk) {
     return chunk->code[chunk->count - 1];
 }
 
+static inline bool isSiteDeoptimized(Chunk* chunk, int offset) {
+    return chunk->deoptimizedSites != NULL && (chunk->deoptimizedSites[offset >> 3] & (1 << (offset & 7)));
+}
+
+static inline InlineCacheEntry* getInlineCacheEntry(InlineCache* inlineCache, InlineCacheType type, int id) {
+    for (int i = 0; i < inlineCache->count; i++) {
+        InlineCacheEntry* entry = &inlineCache->entries[i];
+        if (entry->type == type && entry->id == id) return entry;
+    }
+    return NULL;
+}
+
+static inline InlineCacheEntry* getMethodCacheEntry(InlineCache* inlineCache, int behaviorID, int shapeID, int version) {
+    for (int i = 0; i < inlineCache->count; i++) {
+        InlineCacheEntry* entry = &inlineCache->entries[i];
+        if (entry->type == CACHE_METHOD && entry->id == behaviorID && entry->shapeID == shapeID && entry->version == version) return entry;
+    }
+    return NULL;
+}
+
+static inline InlineCacheEntry* allocateInlineCacheEntry(InlineCache* inlineCache) {
+    if (inlineCache->isMegamorphic) {
+        if (++inlineCache->missCount < INLINE_CACHE_RETRY_MISSES) return NULL;
+        inlineCache->count = 0;
+        inlineCache->missCount = 0;
+        inlineCache->isMegamorphic = false;
+    }
+
+    if (inlineCache->count == INLINE_CACHE_SIZE) {
+        inlineCache->isMegamorphic = true;
+        return NULL;
+    }
+    return &inlineCache->entries[inlineCache->count++];
+}
+
 static inline void writeInlineCache(InlineCache* inlineCache, InlineCacheType type, int id, int index) {
-    inlineCache->type = type;
-    inlineCache->id = id;
-    inlineCache->index = index;
+    InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, type, id);
+    if (entry == NULL) entry = allocateInlineCacheEntry(inlineCache);
+    if (entry == NULL) return;
+
+    entry->type = type;
+    entry->id = id;
+    entry->index = index;
+}
+
+// A method cache entry is valid only while the receiver's behaviorID and shapeID match and its class still has the same
+// methodVersion. Defining or overriding a method on the class bumps methodVersion, which invalidates its entries.
+static inline void writeMethodCache(InlineCache* inlineCache, int behaviorID, int shapeID, int version, Value method) {
+    InlineCacheEntry* entry = NULL;
+    for (int i = 0; i < inlineCache->count; i++) {
+        InlineCacheEntry* current = &inlineCache->entries[i];
+        if (current->type == CACHE_METHOD && current->id == behaviorID && current->shapeID == shapeID) {
+            entry = current;
+            break;
+        }
+    }
+    if (entry == NULL) entry = allocateInlineCacheEntry(inlineCache);
+    if (entry == NULL) return;
+
+    entry->type = CACHE_METHOD;
+    entry->id = behaviorID;
+    entry->index = -1;
+    entry->shapeID = shapeID;
+    entry->version = version;
+    entry->method = method;
+}
+
+static inline void writeTransitionCache(InlineCache* inlineCache, int oldShapeID, int newShapeID, int index) {
+    InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_TRANSITION, oldShapeID);
+    if (entry == NULL) entry = allocateInlineCacheEntry(inlineCache);
+    if (entry == NULL) return;
+
+    entry->type = CACHE_TRANSITION;
+    entry->id = oldShapeID;
+    entry->index = index;
+    entry->shapeID = newShapeID;
 }
 
 #endif // !clox_chunk_h
\ No newline at end of file
@@ -5,8 +5,11 @@
 
 #include "compiler.h"
 #include "lexer.h"
+#include "optimizer.h"
 #include "parser.h"
+#include "peephole.h"
 #include "resolver.h"
+#include "serializer.h"
 #include "typechecker.h"
 #include "../vm/debug.h"
 #include "../vm/memory.h"
@@ -57,9 +60,7 @@ typedef struct SwitchCompiler {
 
 typedef struct TryCompiler {
     struct TryCompiler* enclosing;
-    int exceptionType;
-    int catchAddress;
-    int finallyAddress;
+    int handler;
     int catchJump;
     int finallyJump;
 } TryCompiler;
@@ -111,6 +112,12 @@ static void emitBytes(Compiler* compiler, uint8_t byte1, uint8_t byte2) {
     emitByte(compiler, byte2);
 }
 
+static void emitInlineCache(Compiler* compiler) {
+    int inlineCache = addInlineCache(compiler->vm, currentChunk(compiler));
+    if (inlineCache > UINT16_MAX) compileError(compiler, "Too many inline caches in one chunk.");
+    emitBytes(compiler, (inlineCache >> 8) & 0xff, inlineCache & 0xff);
+}
+
 static int emitJump(Compiler* compiler, uint8_t instruction) {
     emitByte(compiler, instruction);
     emitByte(compiler, 0xff);
@@ -118,6 +125,13 @@ static int emitJump(Compiler* compiler, uint8_t instruction) {
     return currentChunk(compiler)->count - 2;
 }
 
+static int emitForIter(Compiler* compiler, uint8_t slot) {
+    emitBytes(compiler, OP_FOR_ITER, slot);
+    emitBytes(compiler, 0xff, 0xff);
+    emitBytes(compiler, 0xff, 0xff);
+    return currentChunk(compiler)->count - 4;
+}
+
 static void emitLoop(Compiler* compiler) {
     emitByte(compiler, OP_LOOP);
     int offset = currentChunk(compiler)->count - compiler->currentLoop->start + 2;
@@ -138,7 +152,9 @@ static void emitReturn(Compiler* compiler, uint8_t depth) {
 }
 
 static uint8_t makeConstant(Compiler* compiler, Value value) {
-    int constant = addConstant(compiler->vm, currentChunk(compiler), value);
+    VM* vm = compiler->vm;
+    PROCESS_WRITE_BARRIER((Obj*)compiler->function, value);
+    int constant = addConstant(vm, currentChunk(compiler), value);
     if (constant > UINT8_MAX) {
         compileError(compiler, "Too many constants in one chunk.");
         return 0;
@@ -159,9 +175,16 @@ static void patchJump(Compiler* compiler, int offset) {
     currentChunk(compiler)->code[offset + 1] = jump & 0xff;
 }
 
-static void patchAddress(Compiler* compiler, int offset) {
-    currentChunk(compiler)->code[offset] = (currentChunk(compiler)->count >> 8) & 0xff;
-    currentChunk(compiler)->code[offset + 1] = currentChunk(compiler)->count & 0xff;
+static uint16_t currentAddress(Compiler* compiler) {
+    int address = currentChunk(compiler)->count;
+    if (address >= UINT16_MAX) {
+        compileError(compiler, "Too much code to address an exception handler.");
+    }
+    return (uint16_t)address;
+}
+
+static ExceptionHandler* currentHandler(Compiler* compiler) {
+    return &currentChunk(compiler)->handlers[compiler->currentTry->handler];
 }
 
 static void initClassCompiler(Compiler* compiler, ClassCompiler* _class, Token name, BehaviorType type) {
@@ -222,15 +245,7 @@ static void endSwitchCompiler(Compiler* compiler) {
 
 static void initTryCompiler(Compiler* compiler, TryCompiler* try) {
     try->enclosing = compiler->currentTry;
-    emitByte(compiler, OP_TRY);
-    try->exceptionType = currentChunk(compiler)->count;
-    emitByte(compiler, 0xff);
-
-    try->catchAddress = currentChunk(compiler)->count;
-    emitBytes(compiler, 0xff, 0xff);
-    try->finallyAddress = currentChunk(compiler)->count;
-    emitBytes(compiler, 0xff, 0xff);
-
+    try->handler = addExceptionHandler(compiler->vm, currentChunk(compiler), currentAddress(compiler));
     try->catchJump = -1;
     try->finallyJump = -1;
     compiler->currentTry = try;
@@ -257,6 +272,7 @@ static void initCompiler(VM* vm, Compiler* compiler, Compiler* enclosing, Compil
     compiler->debugCode = debugCode;
     compiler->hadError = false;
     compiler->function = newFunction(vm, (type == COMPILE_TYPE_SCRIPT) ? NULL : copyStringPerma(vm, name->start, name->length), isAsync);
+    compiler->function->interceptor = getInterceptorType(vm, compiler->function->name);
     initIDMap(&compiler->indexes, GC_GENERATION_TYPE_PERMANENT);
     vm->compiler = compiler;
 
@@ -285,8 +301,12 @@ static void initCompiler(VM* vm, Compiler* compiler, Compiler* enclosing, Compil
 static ObjFunction* endCompiler(Compiler* compiler) {
     emitReturn(compiler, 0);
     ObjFunction* function = compiler->function;
-    if (compiler->debugCode && !compiler->hadError) {
-        disassembleChunk(currentChunk(compiler), function->name != NULL ? function->name->chars : "<script>");
+    if (!compiler->hadError) {
+        int fusedCount = peepholeOptimize(compiler->vm, currentChunk(compiler));
+        if (compiler->debugCode) {
+            disassembleChunk(currentChunk(compiler), function->name != NULL ? function->name->chars : "<script>");
+            printf("-- %d instructions fused --\n", fusedCount);
+        }
     }
 
     freeIDMap(compiler->vm, &compiler->indexes);
@@ -315,7 +335,9 @@ static uint8_t makeIdentifier(Compiler* compiler, Value value) {
     int identifier;
 
     if (!idMapGet(&compiler->indexes, name, &identifier)) {
-        identifier = addIdentifier(compiler->vm, currentChunk(compiler), value);
+        VM* vm = compiler->vm;
+        PROCESS_WRITE_BARRIER((Obj*)compiler->function, value);
+        identifier = addIdentifier(vm, currentChunk(compiler), value);
         if (identifier > UINT8_MAX) {
             compileError(compiler, "Too many identifiers in one chunk.");
             return -1;
@@ -427,6 +449,7 @@ static void invokeMethod(Compiler* compiler, int args, const char* name, int len
     emitByte(compiler, OP_INVOKE);
     emitByte(compiler, slot);
     emitByte(compiler, args);
+    emitInlineCache(compiler);
 }
 
 static void declareVariable(Compiler* compiler, Token* name) {
@@ -505,6 +528,7 @@ static void getVariable(Compiler* compiler, SymbolItem* item) {
             break;
         default:
             emitBytes(compiler, OP_GET_GLOBAL, (uint8_t)identifierConstant(compiler, &item->token));
+            emitInlineCache(compiler);
     }
 }
 
@@ -657,19 +681,40 @@ static void compileAwait(Compiler* compiler, Ast* ast) {
     await(compiler, ast);
 }
 
+static bool hasNativeType(Ast* ast, ObjClass* klass) {
+    return ast->type != NULL && ast->type->fullName == klass->fullName;
+}
+
+static OpCode specializeBinaryOp(Compiler* compiler, Ast* ast, OpCode opCode) {
+    Ast* left = astGetChild(ast, 0);
+    Ast* right = astGetChild(ast, 1);
+    bool isInt = hasNativeType(left, compiler->vm->intClass) && hasNativeType(right, compiler->vm->intClass);
+    bool isFloat = hasNativeType(left, compiler->vm->floatClass) && hasNativeType(right, compiler->vm->floatClass);
+    bool isString = hasNativeType(left, compiler->vm->stringClass) && hasNativeType(right, compiler->vm->stringClass);
+
+    switch (opCode) {
+        case OP_EQUAL: return isInt ? OP_EQUAL_INT : opCode;
+        case OP_GREATER: return isInt ? OP_GREATER_INT : (isFloat ? OP_GREATER_FLOAT : opCode);
+        case OP_LESS: return isInt ? OP_LESS_INT : (isFloat ? OP_LESS_FLOAT : opCode);
+        case OP_ADD: return isInt ? OP_ADD_INT : (isFloat ? OP_ADD_FLOAT : (isString ? OP_ADD_STRING : opCode));
+        case OP_SUBTRACT: return isInt ? OP_SUBTRACT_INT : (isFloat ? OP_SUBTRACT_FLOAT : opCode);
+        default: return opCode;
+    }
+}
+
 static void compileBinary(Compiler* compiler, Ast* ast) {
     compileChild(compiler, ast, 0);
     compileChild(compiler, ast, 1);
     
     switch (ast->token.type) {
-        case TOKEN_SYMBOL_BANG_EQUAL:        emitBytes(compiler, OP_EQUAL, OP_NOT); break;
-        case TOKEN_SYMBOL_EQUAL_EQUAL:       emitByte(compiler, OP_EQUAL); break;
-        case TOKEN_SYMBOL_GREATER:           emitByte(compiler, OP_GREATER); break;
-        case TOKEN_SYMBOL_GREATER_EQUAL:     emitBytes(compiler, OP_LESS, OP_NOT); break;
-        case TOKEN_SYMBOL_LESS:              emitByte(compiler, OP_LESS); break;
-        case TOKEN_SYMBOL_LESS_EQUAL:        emitBytes(compiler, OP_GREATER, OP_NOT); break;
-        case TOKEN_SYMBOL_PLUS:              emitByte(compiler, OP_ADD); break;
-        case TOKEN_SYMBOL_MINUS:             emitByte(compiler, OP_SUBTRACT); break;
+        case TOKEN_SYMBOL_BANG_EQUAL:        emitBytes(compiler, specializeBinaryOp(compiler, ast, OP_EQUAL), OP_NOT); break;
+        case TOKEN_SYMBOL_EQUAL_EQUAL:       emitByte(compiler, specializeBinaryOp(compiler, ast, OP_EQUAL)); break;
+        case TOKEN_SYMBOL_GREATER:           emitByte(compiler, specializeBinaryOp(compiler, ast, OP_GREATER)); break;
+        case TOKEN_SYMBOL_GREATER_EQUAL:     emitBytes(compiler, specializeBinaryOp(compiler, ast, OP_LESS), OP_NOT); break;
+        case TOKEN_SYMBOL_LESS:              emitByte(compiler, specializeBinaryOp(compiler, ast, OP_LESS)); break;
+        case TOKEN_SYMBOL_LESS_EQUAL:        emitBytes(compiler, specializeBinaryOp(compiler, ast, OP_GREATER), OP_NOT); break;
+        case TOKEN_SYMBOL_PLUS:              emitByte(compiler, specializeBinaryOp(compiler, ast, OP_ADD)); break;
+        case TOKEN_SYMBOL_MINUS:             emitByte(compiler, specializeBinaryOp(compiler, ast, OP_SUBTRACT)); break;
         case TOKEN_SYMBOL_STAR:              emitByte(compiler, OP_MULTIPLY); break;
         case TOKEN_SYMBOL_SLASH:             emitByte(compiler, OP_DIVIDE); break;
         case TOKEN_SYMBOL_MODULO:            emitByte(compiler, OP_MODULO); break;
@@ -714,32 +759,24 @@ static void compileGrouping(Compiler* compiler, Ast* ast) {
 
 static void compileInterpolation(Compiler* compiler, Ast* ast) {
     Ast* exprs = astGetChild(ast, 0);
-    int count = 0;
-    while (count < exprs->children->count) {
-        bool concatenate = false;
-        bool isString = false;
-        Ast* expr = astGetChild(exprs, count);
-
-        if (expr->kind == AST_EXPR_LITERAL && expr->token.type == TOKEN_SYMBOL_STRING) {
-            compileChild(compiler, exprs, count);
-            if (count > 0) emitByte(compiler, OP_ADD);
-            concatenate = true;
-            isString = true;
-            count++;            
-            if (count >= exprs->children->count) break;
-        }
+    int count = exprs->children->count;
+    if (count > UINT8_MAX) {
+        compileError(compiler, "Can't have more than 255 parts in string interpolation.");
+    }
 
-        compileChild(compiler, exprs, count);
-        expr = astGetChild(exprs, count);
-        if (expr->type == NULL || !isSubtypeOfType(expr->type, getNativeType(compiler->vm, "String"))) {
-            invokeMethod(compiler, 0, "toString", 8);
-        }
+    for (int i = 0; i < count; i++) {
+        Ast* expr = astGetChild(exprs, i);
+        compileChild(compiler, exprs, i);
+        if (expr->kind == AST_EXPR_LITERAL && expr->token.type == TOKEN_SYMBOL_STRING) continue;
 
-        if (concatenate || (count >= 1 && !isString)) {
-            emitByte(compiler, OP_ADD);
+        if (!hasNativeType(expr, compiler->vm->stringClass)) {
+            int slot = makeIdentifier(compiler, OBJ_VAL(copyStringPerma(compiler->vm, "toString", 8)));
+            emitBytes(compiler, OP_TO_STRING, slot);
+            emitByte(compiler, 0);
+            emitInlineCache(compiler);
         }
-        count++;
     }
+    emitBytes(compiler, OP_INTERPOLATE, count);
 }
 
 static void compileInvoke(Compiler* compiler, Ast* ast) {
@@ -751,6 +788,7 @@ static void compileInvoke(Compiler* compiler, Ast* ast) {
     OpCode opCode = ast->attribute.isOptional ? OP_OPTIONAL_INVOKE : OP_INVOKE;
     emitBytes(compiler, opCode, methodIndex);
     emitByte(compiler, argCount);
+    emitInlineCache(compiler);
 }
 
 static void compileLiteral(Compiler* compiler, Ast* ast) {
@@ -796,6 +834,7 @@ static void compilePropertyGet(Compiler* compiler, Ast* ast) {
     uint8_t index = identifierConstant(compiler, &ast->token);
     OpCode opCode = ast->attribute.isOptional ? OP_GET_PROPERTY_OPTIONAL : OP_GET_PROPERTY;
     emitBytes(compiler, opCode, index);
+    emitInlineCache(compiler);
 }
 
 static void compilePropertySet(Compiler* compiler, Ast* ast) {
@@ -803,12 +842,17 @@ static void compilePropertySet(Compiler* compiler, Ast* ast) {
     uint8_t index = identifierConstant(compiler, &ast->token);
     compileChild(compiler, ast, 1);
     emitBytes(compiler, OP_SET_PROPERTY, index);
+    emitInlineCache(compiler);
 }
 
 static void compileSubscriptGet(Compiler* compiler, Ast* ast) {
     compileChild(compiler, ast, 0);
     compileChild(compiler, ast, 1);
     OpCode opCode = ast->attribute.isOptional ? OP_GET_SUBSCRIPT_OPTIONAL : OP_GET_SUBSCRIPT;
+    if (opCode == OP_GET_SUBSCRIPT && hasNativeType(astGetChild(ast, 0), compiler->vm->arrayClass) 
+        && hasNativeType(astGetChild(ast, 1), compiler->vm->intClass)) {
+        opCode = OP_GET_SUBSCRIPT_ARRAY_INT;
+    }
     emitByte(compiler, opCode);
 }
 
@@ -833,6 +877,7 @@ static void compileSuperInvoke(Compiler* compiler, Ast* ast) {
     getVariable(compiler, findSymbolItem(compiler, ast->symtab, compiler->currentClass->superclass));
     emitBytes(compiler, OP_SUPER_INVOKE, index);
     emitByte(compiler, argCount);
+    emitInlineCache(compiler);
 }
 
 static void compileThis(Compiler* compiler, Ast* ast) {
@@ -987,8 +1032,8 @@ static void compileCaseStatement(Compiler* compiler, Ast* ast) {
 static void compileCatchStatement(Compiler* compiler, Ast* ast) {
     beginScope(compiler);
     uint8_t typeIndex = identifierConstant(compiler, &ast->token);
-    currentChunk(compiler)->code[compiler->currentTry->exceptionType] = typeIndex;
-    patchAddress(compiler, compiler->currentTry->catchAddress);
+    currentHandler(compiler)->exceptionType = typeIndex;
+    currentHandler(compiler)->handlerAddress = currentAddress(compiler);
 
     if (astNumChild(ast) > 1) {
         Ast* var = astGetChild(ast, 0);
@@ -997,8 +1042,6 @@ static void compileCatchStatement(Compiler* compiler, Ast* ast) {
         uint8_t varIndex = findLocal(compiler, &var->token);
         emitBytes(compiler, OP_SET_LOCAL, varIndex);
     }
-
-    emitByte(compiler, OP_CATCH);
     compileChild(compiler, ast, ast->children->count - 1);
     endScope(compiler);
 }
@@ -1024,7 +1067,7 @@ static void compileExpressionStatement(Compiler* compiler, Ast* ast) {
 
 static void compileFinallyStatement(Compiler* compiler, Ast* ast) {
     emitByte(compiler, OP_FALSE);
-    patchAddress(compiler, compiler->currentTry->finallyAddress);
+    currentHandler(compiler)->finallyAddress = currentAddress(compiler);
     compileChild(compiler, ast, 0);
     compiler->currentTry->finallyJump = emitJump(compiler, OP_JUMP_IF_FALSE);
 
@@ -1048,13 +1091,16 @@ static void compileForStatement(Compiler* compiler, Ast* ast) {
     }
 
     compileChild(compiler, ast, 1);
-    if (compiler->localCount + 3 > UINT8_MAX) {
-        compileError(compiler, "for loop can only contain up to 252 variables.");
+    if (compiler->localCount + 4 > UINT8_MAX) {
+        compileError(compiler, "for loop can only contain up to 251 variables.");
     }
 
     int iteratorSlot = addLocal(compiler, syntheticToken("iterator "));
+    int prepJump = emitJump(compiler, OP_FOR_PREP);
     invokeMethod(compiler, 0, "iterator", 8);
-    setLocal(compiler, iteratorSlot);
+    emitByte(compiler, OP_NIL);
+    patchJump(compiler, prepJump);
+    addLocal(compiler, syntheticToken("position "));
     emitByte(compiler, OP_NIL);
     int indexSlot = addLocal(compiler, indexToken);
     markInitialized(compiler, true);
@@ -1062,6 +1108,7 @@ static void compileForStatement(Compiler* compiler, Ast* ast) {
     LoopCompiler* outerLoop = compiler->currentLoop;
     LoopCompiler innerLoop;
     initLoopCompiler(compiler, &innerLoop);
+    int iterJump = emitForIter(compiler, iteratorSlot);
     getLocal(compiler, iteratorSlot);
     invokeMethod(compiler, 0, "moveNext", 8);
 
@@ -1071,24 +1118,26 @@ static void compileForStatement(Compiler* compiler, Ast* ast) {
     invokeMethod(compiler, 0, "currentIndex", 12);
     setLocal(compiler, indexSlot);
     emitByte(compiler, OP_POP);
+    getLocal(compiler, iteratorSlot);
+    invokeMethod(compiler, 0, "currentValue", 12);
+    patchJump(compiler, iterJump);
 
     beginScope(compiler);
-    int valueSlot = addLocal(compiler, valueToken);
+    addLocal(compiler, valueToken);
     markInitialized(compiler, false);
-    getLocal(compiler, iteratorSlot);
-    invokeMethod(compiler, 0, "currentValue", 12);
-    setLocal(compiler, valueSlot);
     compileChild(compiler, ast, 2);
     endScope(compiler);
 
     emitLoop(compiler);
     patchJump(compiler, compiler->currentLoop->exitJump);
+    emitByte(compiler, OP_POP);
+    patchJump(compiler, iterJump + 2);
     endLoopCompiler(compiler);
     emitByte(compiler, OP_POP);
     emitByte(compiler, OP_POP);
     emitByte(compiler, OP_POP);
 
-    compiler->localCount -= 2;
+    compiler->localCount -= 3;
     compiler->currentLoop = outerLoop;
     endScope(compiler);
 }
@@ -1112,13 +1161,28 @@ static void compileRequireStatement(Compiler* compiler, Ast* ast) {
     emitByte(compiler, OP_REQUIRE);
 }
 
+static bool isTailCall(Compiler* compiler, Ast* ast) {
+    if (ast->kind != AST_EXPR_CALL || ast->attribute.isOptional) return false;
+    if (compiler->type != COMPILE_TYPE_FUNCTION && compiler->type != COMPILE_TYPE_METHOD) return false;
+    if (compiler->isAsync || compiler->function->isGenerator) return false;
+    TryCompiler* enclosingTry = (compiler->enclosing != NULL) ? compiler->enclosing->currentTry : NULL;
+    return compiler->currentTry == enclosingTry;
+}
+
 static void compileReturnStatement(Compiler* compiler, Ast* ast) {
     uint8_t depth = 0;
     if (compiler->type == COMPILE_TYPE_LAMBDA) {
         depth = lambdaDepth(compiler);
     }
 
-    if (astHasChild(ast)) {
+    if (astHasChild(ast) && isTailCall(compiler, astGetChild(ast, 0))) {
+        Ast* call = astGetChild(ast, 0);
+        compileChild(compiler, call, 0);
+        uint8_t argCount = argumentList(compiler, astGetChild(call, 1));
+        emitBytes(compiler, OP_TAIL_CALL, argCount);
+        emitByte(compiler, OP_RETURN);
+    }
+    else if (astHasChild(ast)) {
         compileChild(compiler, ast, 0);
         if (compiler->type == COMPILE_TYPE_LAMBDA) emitBytes(compiler, OP_RETURN_NONLOCAL, depth);
         else emitByte(compiler, OP_RETURN);
@@ -1149,7 +1213,7 @@ static void compileTryStatement(Compiler* compiler, Ast* ast) {
     TryCompiler innerTry;
     initTryCompiler(compiler, &innerTry);
     compileChild(compiler, ast, 0);
-    emitByte(compiler, OP_CATCH);
+    currentHandler(compiler)->endAddress = currentAddress(compiler);
     compiler->currentTry->catchJump = emitJump(compiler, OP_JUMP);
 
     compileChild(compiler, ast, 1);
@@ -1438,6 +1502,13 @@ ObjFunction* compile(VM* vm, const char* source) {
         return NULL;
     }
 
+    if (vm->config.optimizeAst) {
+        Optimizer optimizer;
+        initOptimizer(vm, &optimizer);
+        optimize(&optimizer, ast);
+        freeOptimizer(&optimizer);
+    }
+
     Compiler compiler;
     initCompiler(vm, &compiler, NULL, COMPILE_TYPE_SCRIPT, NULL, false, vm->config.debugCode);
     compileAst(&compiler, ast);
@@ -1446,4 +1517,23 @@ ObjFunction* compile(VM* vm, const char* source) {
     freeCompilerIR(tokens, ast, nametab);
     if (compiler.hadError) return NULL;
     return function;
+}
+
+ObjFunction* compileModule(VM* vm, ObjString* path, const char* source, bool fromSource) {
+    bool useBytecode = vm->config.cacheBytecode || strlen(vm->config.cachePath) > 0;
+    if (!useBytecode || path->length == 0) return compile(vm, source);
+    if (!fromSource) {
+        ObjFunction* function = loadBytecode(vm, path, source);
+        if (function != NULL) return function;
+    }
+
+    int valStart = vm->currentModule->valFields.count;
+    int varStart = vm->currentModule->varFields.count;
+    ObjFunction* function = compile(vm, source);
+    if (function == NULL) return NULL;
+
+    push(vm, OBJ_VAL(function));
+    saveBytecode(vm, path, source, function, valStart, varStart);
+    pop(vm);
+    return function;
 }
\ No newline at end of file
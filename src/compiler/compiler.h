@@ -8,5 +8,6 @@
 void compileAst(Compiler* compiler, Ast* ast);
 void compileChild(Compiler* compiler, Ast* ast, int index);
 ObjFunction* compile(VM* vm, const char* source);
+ObjFunction* compileModule(VM* vm, ObjString* path, const char* source, bool fromSource);
 
 #endif // !clox_compiler_h
\ No newline at end of file
@@ -0,0 +1,447 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "optimizer.h"
+#include "../vm/hash.h"
+#include "../vm/string.h"
+#include "../vm/vm.h"
+
+DEFINE_BUFFER(SymbolItemArray, SymbolItem*)
+
+void initOptimizer(VM* vm, Optimizer* optimizer) {
+    optimizer->vm = vm;
+    SymbolItemArrayInit(&optimizer->constantItems);
+    AstForestInit(&optimizer->constantValues);
+    optimizer->optimizedCount = 0;
+}
+
+void freeOptimizer(Optimizer* optimizer) {
+    SymbolItemArrayFree(&optimizer->constantItems);
+    AstForestFree(&optimizer->constantValues);
+}
+
+static Ast* optimizeNode(Optimizer* optimizer, Ast* ast);
+
+static SymbolItem* findSymbolItem(Optimizer* optimizer, Ast* ast) {
+    if (ast->symtab == NULL) return NULL;
+    uint32_t hash = hashString(ast->token.start, ast->token.length);
+    ObjString* name = tableFindString(&optimizer->vm->strings, ast->token.start, ast->token.length, hash);
+    return (name != NULL) ? symbolTableLookup(ast->symtab, name) : NULL;
+}
+
+static bool literalValue(Optimizer* optimizer, Ast* ast, Value* value) {
+    if (ast->kind != AST_EXPR_LITERAL) return false;
+    Token token = ast->token;
+
+    switch (token.type) {
+        case TOKEN_SYMBOL_NIL: *value = NIL_VAL; return true;
+        case TOKEN_SYMBOL_TRUE: *value = BOOL_VAL(true); return true;
+        case TOKEN_SYMBOL_FALSE: *value = BOOL_VAL(false); return true;
+        case TOKEN_SYMBOL_INT: *value = INT_VAL((int)strtol(token.start, NULL, 10)); return true;
+        case TOKEN_SYMBOL_NUMBER: *value = NUMBER_VAL(strtod(token.start, NULL)); return true;
+        case TOKEN_SYMBOL_STRING: *value = OBJ_VAL(copyStringPerma(optimizer->vm, token.start, token.length)); return true;
+        default: return false;
+    }
+}
+
+static Token literalToken(Optimizer* optimizer, Token token, Value value) {
+    char chars[32];
+    ObjString* string = NULL;
+
+    if (IS_NIL(value)) {
+        token.type = TOKEN_SYMBOL_NIL;
+        token.start = "nil";
+    }
+    else if (IS_BOOL(value)) {
+        token.type = AS_BOOL(value) ? TOKEN_SYMBOL_TRUE : TOKEN_SYMBOL_FALSE;
+        token.start = AS_BOOL(value) ? "true" : "false";
+    }
+    else if (IS_INT(value)) {
+        int length = snprintf(chars, sizeof(chars), "%d", AS_INT(value));
+        string = copyStringPerma(optimizer->vm, chars, length);
+        token.type = TOKEN_SYMBOL_INT;
+    }
+    else if (IS_FLOAT(value)) {
+        int length = snprintf(chars, sizeof(chars), "%.17g", AS_FLOAT(value));
+        string = copyStringPerma(optimizer->vm, chars, length);
+        token.type = TOKEN_SYMBOL_NUMBER;
+    }
+    else {
+        string = AS_STRING(value);
+        token.type = TOKEN_SYMBOL_STRING;
+    }
+
+    if (string != NULL) {
+        token.start = string->chars;
+        token.length = string->length;
+    }
+    else token.length = (int)strlen(token.start);
+    return token;
+}
+
+static Ast* detachChild(Ast* ast, int index) {
+    Ast* child = astGetChild(ast, index);
+    AstForestDelete(ast->children, index);
+    return child;
+}
+
+static void replaceWithLiteral(Optimizer* optimizer, Ast* ast, Value value) {
+    for (int i = 0; i < ast->children->count; i++) {
+        freeAst(ast->children->elements[i], true);
+    }
+    ast->children->count = 0;
+    ast->kind = AST_EXPR_LITERAL;
+    ast->category = AST_CATEGORY_EXPR;
+    ast->token = literalToken(optimizer, ast->token, value);
+    optimizer->optimizedCount++;
+}
+
+static ObjString* concatenateLiterals(Optimizer* optimizer, ObjString* string, ObjString* string2) {
+    int length = string->length + string2->length;
+    char* chars = bufferNewCString(length);
+    memcpy(chars, string->chars, string->length);
+    memcpy(chars + string->length, string2->chars, string2->length);
+    chars[length] = '\0';
+    return takeStringPerma(optimizer->vm, chars, length);
+}
+
+static bool foldInt(TokenSymbol operator, int a, int b, Value* result) {
+    long long value = 0;
+    switch (operator) {
+        case TOKEN_SYMBOL_PLUS: value = (long long)a + b; break;
+        case TOKEN_SYMBOL_MINUS: value = (long long)a - b; break;
+        case TOKEN_SYMBOL_STAR: value = (long long)a * b; break;
+        case TOKEN_SYMBOL_MODULO:
+            if (b == 0 || (a == INT_MIN && b == -1)) return false;
+            value = a % b;
+            break;
+        case TOKEN_SYMBOL_SLASH:
+            if (b == 0) return false;
+            *result = NUMBER_VAL((double)a / b);
+            return true;
+        case TOKEN_SYMBOL_EQUAL_EQUAL: *result = BOOL_VAL(a == b); return true;
+        case TOKEN_SYMBOL_BANG_EQUAL: *result = BOOL_VAL(a != b); return true;
+        case TOKEN_SYMBOL_GREATER: *result = BOOL_VAL(a > b); return true;
+        case TOKEN_SYMBOL_GREATER_EQUAL: *result = BOOL_VAL(!(a < b)); return true;
+        case TOKEN_SYMBOL_LESS: *result = BOOL_VAL(a < b); return true;
+        case TOKEN_SYMBOL_LESS_EQUAL: *result = BOOL_VAL(!(a > b)); return true;
+        default: return false;
+    }
+
+    if (value < INT_MIN || value > INT_MAX) return false;
+    *result = INT_VAL((int)value);
+    return true;
+}
+
+static bool foldNumber(TokenSymbol operator, double a, double b, Value* result) {
+    double value = 0.0;
+    switch (operator) {
+        case TOKEN_SYMBOL_PLUS: value = a + b; break;
+        case TOKEN_SYMBOL_MINUS: value = a - b; break;
+        case TOKEN_SYMBOL_STAR: value = a * b; break;
+        case TOKEN_SYMBOL_SLASH:
+            if (b == 0.0) return false;
+            value = a / b;
+            break;
+        case TOKEN_SYMBOL_MODULO:
+            if (b == 0.0) return false;
+            value = fmod(a, b);
+            break;
+        case TOKEN_SYMBOL_EQUAL_EQUAL: *result = BOOL_VAL(a == b); return true;
+        case TOKEN_SYMBOL_BANG_EQUAL: *result = BOOL_VAL(a != b); return true;
+        case TOKEN_SYMBOL_GREATER: *result = BOOL_VAL(a > b); return true;
+        case TOKEN_SYMBOL_GREATER_EQUAL: *result = BOOL_VAL(!(a < b)); return true;
+        case TOKEN_SYMBOL_LESS: *result = BOOL_VAL(a < b); return true;
+        case TOKEN_SYMBOL_LESS_EQUAL: *result = BOOL_VAL(!(a > b)); return true;
+        default: return false;
+    }
+
+    if (!isfinite(value)) return false;
+    *result = NUMBER_VAL(value);
+    return true;
+}
+
+static void foldBinary(Optimizer* optimizer, Ast* ast) {
+    Value a, b, result;
+    if (!literalValue(optimizer, astGetChild(ast, 0), &a) || !literalValue(optimizer, astGetChild(ast, 1), &b)) return;
+
+    if (IS_STRING(a) && IS_STRING(b)) {
+        if (ast->token.type != TOKEN_SYMBOL_PLUS) return;
+        result = OBJ_VAL(concatenateLiterals(optimizer, AS_STRING(a), AS_STRING(b)));
+    }
+    else if (IS_INT(a) && IS_INT(b)) {
+        if (!foldInt(ast->token.type, AS_INT(a), AS_INT(b), &result)) return;
+    }
+    else if (IS_NUMBER(a) && IS_NUMBER(b)) {
+        if (!foldNumber(ast->token.type, AS_NUMBER(a), AS_NUMBER(b), &result)) return;
+    }
+    else return;
+    replaceWithLiteral(optimizer, ast, result);
+}
+
+static void foldUnary(Optimizer* optimizer, Ast* ast) {
+    Value value;
+    if (!literalValue(optimizer, astGetChild(ast, 0), &value)) return;
+
+    switch (ast->token.type) {
+        case TOKEN_SYMBOL_BANG:
+            replaceWithLiteral(optimizer, ast, BOOL_VAL(isFalsey(value)));
+            break;
+        case TOKEN_SYMBOL_MINUS:
+            if (IS_INT(value) && AS_INT(value) != INT_MIN) replaceWithLiteral(optimizer, ast, INT_VAL(-AS_INT(value)));
+            else if (IS_FLOAT(value)) replaceWithLiteral(optimizer, ast, NUMBER_VAL(-AS_FLOAT(value)));
+            break;
+        default:
+            break;
+    }
+}
+
+static void foldGrouping(Optimizer* optimizer, Ast* ast) {
+    Value value;
+    if (literalValue(optimizer, astGetChild(ast, 0), &value)) {
+        replaceWithLiteral(optimizer, ast, value);
+    }
+}
+
+static Ast* foldLogical(Optimizer* optimizer, Ast* ast) {
+    Value value;
+    if (!literalValue(optimizer, astGetChild(ast, 0), &value)) return ast;
+
+    bool isLeft = (ast->kind == AST_EXPR_AND) ? isFalsey(value) : !isFalsey(value);
+    Ast* operand = detachChild(ast, isLeft ? 0 : 1);
+    operand->parent = ast->parent;
+    freeAst(ast, true);
+    optimizer->optimizedCount++;
+    return operand;
+}
+
+static bool interpolationPart(Optimizer* optimizer, Ast* ast, ObjString** string) {
+    Value value;
+    if (!literalValue(optimizer, ast, &value)) return false;
+
+    if (IS_STRING(value)) *string = AS_STRING(value);
+    else if (IS_INT(value)) {
+        char chars[16];
+        int length = snprintf(chars, sizeof(chars), "%d", AS_INT(value));
+        *string = copyStringPerma(optimizer->vm, chars, length);
+    }
+    else return false;
+    return true;
+}
+
+static void foldInterpolation(Optimizer* optimizer, Ast* ast) {
+    Ast* exprs = astGetChild(ast, 0);
+    int count = 0;
+    ObjString* previous = NULL;
+
+    for (int i = 0; i < exprs->children->count; i++) {
+        Ast* expr = exprs->children->elements[i];
+        ObjString* string = NULL;
+
+        if (!interpolationPart(optimizer, expr, &string)) {
+            exprs->children->elements[count++] = expr;
+            previous = NULL;
+        }
+        else if (previous != NULL) {
+            Ast* last = exprs->children->elements[count - 1];
+            previous = concatenateLiterals(optimizer, previous, string);
+            last->token = literalToken(optimizer, last->token, OBJ_VAL(previous));
+            freeAst(expr, true);
+            optimizer->optimizedCount++;
+        }
+        else {
+            expr->token = literalToken(optimizer, expr->token, OBJ_VAL(string));
+            exprs->children->elements[count++] = expr;
+            previous = string;
+        }
+    }
+
+    exprs->children->count = count;
+    for (int i = 0; i < count; i++) {
+        exprs->children->elements[i]->sibling = (i + 1 < count) ? exprs->children->elements[i + 1] : NULL;
+    }
+
+    if (count == 1 && previous != NULL) {
+        replaceWithLiteral(optimizer, ast, OBJ_VAL(previous));
+    }
+}
+
+static void propagateConstant(Optimizer* optimizer, Ast* ast, int index) {
+    Ast* child = astGetChild(ast, index);
+    if (child->kind != AST_EXPR_VARIABLE || optimizer->constantItems.count == 0) return;
+    SymbolItem* item = findSymbolItem(optimizer, child);
+    if (item == NULL || item->category != SYMBOL_CATEGORY_GLOBAL) return;
+
+    int constantIndex = SymbolItemArrayFirstIndex(&optimizer->constantItems, item);
+    if (constantIndex < 0) return;
+    Ast* literal = optimizer->constantValues.elements[constantIndex];
+
+    int line = child->token.line;
+    child->kind = AST_EXPR_LITERAL;
+    child->token = literal->token;
+    child->token.line = line;
+    if (child->type == NULL) child->type = literal->type;
+    optimizer->optimizedCount++;
+}
+
+static void propagateConstants(Optimizer* optimizer, Ast* ast) {
+    for (int i = 0; i < astNumChild(ast); i++) {
+        propagateConstant(optimizer, ast, i);
+    }
+}
+
+static void defineConstant(Optimizer* optimizer, Ast* ast) {
+    if (ast->attribute.isMutable || !astHasChild(ast)) return;
+    Ast* value = astGetChild(ast, 0);
+    if (value->kind != AST_EXPR_LITERAL) return;
+
+    SymbolItem* item = findSymbolItem(optimizer, ast);
+    if (item == NULL || item->category != SYMBOL_CATEGORY_GLOBAL || item->isMutable) return;
+    SymbolItemArrayAdd(&optimizer->constantItems, item);
+    AstForestAdd(&optimizer->constantValues, value);
+}
+
+static bool isValueList(Ast* ast) {
+    if (ast->parent == NULL) return false;
+    switch (ast->parent->kind) {
+        case AST_EXPR_ARRAY:
+        case AST_EXPR_CALL:
+        case AST_EXPR_INTERPOLATION:
+        case AST_EXPR_INVOKE:
+        case AST_EXPR_SUPER_INVOKE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static Ast* eliminateIf(Optimizer* optimizer, Ast* ast) {
+    Value condition;
+    if (!literalValue(optimizer, astGetChild(ast, 0), &condition)) return ast;
+
+    Ast* branch = NULL;
+    if (!isFalsey(condition)) branch = detachChild(ast, 1);
+    else if (astNumChild(ast) > 2) branch = detachChild(ast, 2);
+
+    if (branch != NULL) branch->parent = ast->parent;
+    freeAst(ast, true);
+    optimizer->optimizedCount++;
+    return branch;
+}
+
+static Ast* eliminateWhile(Optimizer* optimizer, Ast* ast) {
+    Value condition;
+    if (!literalValue(optimizer, astGetChild(ast, 0), &condition) || !isFalsey(condition)) return ast;
+    freeAst(ast, true);
+    optimizer->optimizedCount++;
+    return NULL;
+}
+
+static void eliminateUnreachable(Optimizer* optimizer, Ast* ast) {
+    int count = 0;
+    bool isReachable = true;
+
+    for (int i = 0; i < ast->children->count; i++) {
+        Ast* stmt = ast->children->elements[i];
+        if (stmt == NULL) continue;
+
+        if (!isReachable && stmt->category != AST_CATEGORY_DECL) {
+            freeAst(stmt, true);
+            optimizer->optimizedCount++;
+            continue;
+        }
+
+        if (stmt->kind == AST_STMT_RETURN || stmt->kind == AST_STMT_THROW) isReachable = false;
+        ast->children->elements[count++] = stmt;
+    }
+    ast->children->count = count;
+}
+
+static Ast* emptyBlock(Ast* ast) {
+    Ast* stmts = emptyAst(AST_LIST_STMT, ast->token);
+    Ast* block = newAst(AST_STMT_BLOCK, ast->token, 1, stmts);
+    block->symtab = ast->symtab;
+    stmts->symtab = ast->symtab;
+    return block;
+}
+
+static Ast* optimizeNode(Optimizer* optimizer, Ast* ast) {
+    optimizeAst(optimizer, ast);
+
+    switch (ast->kind) {
+        case AST_EXPR_AND:
+        case AST_EXPR_OR:
+            propagateConstants(optimizer, ast);
+            return foldLogical(optimizer, ast);
+        case AST_EXPR_BINARY:
+            propagateConstants(optimizer, ast);
+            foldBinary(optimizer, ast);
+            break;
+        case AST_EXPR_GROUPING:
+            propagateConstants(optimizer, ast);
+            foldGrouping(optimizer, ast);
+            break;
+        case AST_EXPR_INTERPOLATION:
+            foldInterpolation(optimizer, ast);
+            break;
+        case AST_EXPR_UNARY:
+            propagateConstants(optimizer, ast);
+            foldUnary(optimizer, ast);
+            break;
+        case AST_LIST_EXPR:
+            if (isValueList(ast)) propagateConstants(optimizer, ast);
+            break;
+        case AST_STMT_RETURN:
+            propagateConstants(optimizer, ast);
+            break;
+        case AST_STMT_IF:
+            propagateConstant(optimizer, ast, 0);
+            return eliminateIf(optimizer, ast);
+        case AST_STMT_WHILE:
+            propagateConstant(optimizer, ast, 0);
+            return eliminateWhile(optimizer, ast);
+        case AST_DECL_VAR:
+            propagateConstants(optimizer, ast);
+            defineConstant(optimizer, ast);
+            break;
+        default:
+            break;
+    }
+    return ast;
+}
+
+void optimizeAst(Optimizer* optimizer, Ast* ast) {
+    bool isModified = false;
+    for (int i = 0; i < ast->children->count; i++) {
+        Ast* child = ast->children->elements[i];
+        Ast* optimized = optimizeNode(optimizer, child);
+        if (optimized == child) continue;
+
+        if (optimized == NULL && ast->kind != AST_LIST_STMT && ast->kind != AST_KIND_NONE) {
+            optimized = emptyBlock(ast);
+        }
+        ast->children->elements[i] = optimized;
+        isModified = true;
+    }
+
+    if (ast->kind == AST_LIST_STMT || ast->kind == AST_KIND_NONE) {
+        int count = ast->children->count;
+        eliminateUnreachable(optimizer, ast);
+        if (ast->children->count != count) isModified = true;
+    }
+
+    if (isModified) {
+        for (int i = 0; i < ast->children->count; i++) {
+            Ast* child = ast->children->elements[i];
+            child->parent = ast;
+            child->sibling = (i + 1 < ast->children->count) ? ast->children->elements[i + 1] : NULL;
+        }
+    }
+}
+
+void optimize(Optimizer* optimizer, Ast* ast) {
+    optimizeAst(optimizer, ast);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef clox_optimizer_h
+#define clox_optimizer_h
+
+#include "ast.h"
+
+DECLARE_BUFFER(SymbolItemArray, SymbolItem*)
+
+typedef struct {
+    VM* vm;
+    SymbolItemArray constantItems;
+    AstForest constantValues;
+    int optimizedCount;
+} Optimizer;
+
+void initOptimizer(VM* vm, Optimizer* optimizer);
+void freeOptimizer(Optimizer* optimizer);
+void optimizeAst(Optimizer* optimizer, Ast* ast);
+void optimize(Optimizer* optimizer, Ast* ast);
+
+#endif // !clox_optimizer_h
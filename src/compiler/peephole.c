@@ -0,0 +1,247 @@
+#include <string.h>
+
+#include "peephole.h"
+#include "../vm/memory.h"
+
+typedef enum {
+    FIXUP_FORWARD,
+    FIXUP_BACKWARD
+} FixupType;
+
+typedef struct {
+    FixupType type;
+    int offset;
+    int target;
+} JumpFixup;
+
+typedef struct {
+    Chunk* chunk;
+    bool* isTarget;
+    int* offsets;
+    uint8_t* code;
+    int* lines;
+    JumpFixup* fixups;
+    int count;
+    int fixupCount;
+    int fusedCount;
+} Peephole;
+
+static int readShort(Chunk* chunk, int offset) {
+    return (chunk->code[offset] << 8) | chunk->code[offset + 1];
+}
+
+static void writeShort(uint8_t* code, int offset, int value) {
+    code[offset] = (value >> 8) & 0xff;
+    code[offset + 1] = value & 0xff;
+}
+
+static bool isRemovableBeforePop(OpCode opCode) {
+    switch (opCode) {
+        case OP_CONSTANT:
+        case OP_NIL:
+        case OP_TRUE:
+        case OP_FALSE:
+        case OP_GET_LOCAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void markJumpTargets(Chunk* chunk, bool* isTarget) {
+    for (int offset = 0; offset < chunk->count; offset += opCodeOffset(chunk, offset)) {
+        switch (chunk->code[offset]) {
+            case OP_JUMP:
+            case OP_JUMP_IF_FALSE:
+            case OP_FOR_PREP:
+                isTarget[offset + 3 + readShort(chunk, offset + 1)] = true;
+                break;
+            case OP_FOR_ITER:
+                isTarget[offset + 4 + readShort(chunk, offset + 2)] = true;
+                isTarget[offset + 6 + readShort(chunk, offset + 4)] = true;
+                break;
+            case OP_LOOP:
+                isTarget[offset + 3 - readShort(chunk, offset + 1)] = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (int i = 0; i < chunk->handlerCount; i++) {
+        ExceptionHandler* handler = &chunk->handlers[i];
+        isTarget[handler->startAddress] = true;
+        isTarget[handler->endAddress] = true;
+        if (handler->handlerAddress != UINT16_MAX) isTarget[handler->handlerAddress] = true;
+        if (handler->finallyAddress != UINT16_MAX) isTarget[handler->finallyAddress] = true;
+    }
+}
+
+static OpCode fusibleOpCode(Peephole* peephole, int offset) {
+    if (offset >= peephole->chunk->count || peephole->isTarget[offset]) return OP_END;
+    return peephole->chunk->code[offset];
+}
+
+static void emitOptimized(Peephole* peephole, uint8_t byte, int line) {
+    peephole->code[peephole->count] = byte;
+    peephole->lines[peephole->count] = line;
+    peephole->count++;
+}
+
+static void addFixup(Peephole* peephole, FixupType type, int offset, int target) {
+    JumpFixup* fixup = &peephole->fixups[peephole->fixupCount++];
+    fixup->type = type;
+    fixup->offset = offset;
+    fixup->target = target;
+}
+
+static void copyInstruction(Peephole* peephole, int offset, int length) {
+    Chunk* chunk = peephole->chunk;
+    int start = peephole->count;
+    int line = getLine(chunk, offset);
+    for (int i = 0; i < length; i++) {
+        emitOptimized(peephole, chunk->code[offset + i], line);
+    }
+
+    switch (chunk->code[offset]) {
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+        case OP_FOR_PREP:
+            addFixup(peephole, FIXUP_FORWARD, start + 1, offset + 3 + readShort(chunk, offset + 1));
+            break;
+        case OP_FOR_ITER:
+            addFixup(peephole, FIXUP_FORWARD, start + 2, offset + 4 + readShort(chunk, offset + 2));
+            addFixup(peephole, FIXUP_FORWARD, start + 4, offset + 6 + readShort(chunk, offset + 4));
+            break;
+        case OP_LOOP:
+            addFixup(peephole, FIXUP_BACKWARD, start + 1, offset + 3 - readShort(chunk, offset + 1));
+            break;
+        default:
+            break;
+    }
+}
+
+static void compactLines(Chunk* chunk, int* lines) {
+    chunk->lineCount = 0;
+    for (int offset = 0; offset < chunk->count; offset++) {
+        if (chunk->lineCount > 0 && chunk->lines[chunk->lineCount - 1].line == lines[offset]) continue;
+        chunk->lines[chunk->lineCount].offset = offset;
+        chunk->lines[chunk->lineCount].line = lines[offset];
+        chunk->lineCount++;
+    }
+}
+
+static void applyFixups(Peephole* peephole) {
+    for (int i = 0; i < peephole->fixupCount; i++) {
+        JumpFixup* fixup = &peephole->fixups[i];
+        int target = peephole->offsets[fixup->target];
+
+        switch (fixup->type) {
+            case FIXUP_FORWARD:
+                writeShort(peephole->code, fixup->offset, target - (fixup->offset + 2));
+                break;
+            case FIXUP_BACKWARD:
+                writeShort(peephole->code, fixup->offset, (fixup->offset + 2) - target);
+                break;
+        }
+    }
+
+    for (int i = 0; i < peephole->chunk->handlerCount; i++) {
+        ExceptionHandler* handler = &peephole->chunk->handlers[i];
+        handler->startAddress = peephole->offsets[handler->startAddress];
+        handler->endAddress = peephole->offsets[handler->endAddress];
+        if (handler->handlerAddress != UINT16_MAX) handler->handlerAddress = peephole->offsets[handler->handlerAddress];
+        if (handler->finallyAddress != UINT16_MAX) handler->finallyAddress = peephole->offsets[handler->finallyAddress];
+    }
+}
+
+static int fuseInstruction(Peephole* peephole, int offset, int length) {
+    Chunk* chunk = peephole->chunk;
+    OpCode opCode = chunk->code[offset];
+    int next = offset + length;
+    OpCode nextOpCode = fusibleOpCode(peephole, next);
+    int line = getLine(chunk, offset);
+
+    if (nextOpCode == OP_POP && isRemovableBeforePop(opCode)) {
+        peephole->offsets[next] = peephole->count;
+        peephole->fusedCount += 2;
+        return next + 1;
+    }
+
+    if (opCode == OP_GET_LOCAL && nextOpCode == OP_GET_PROPERTY) {
+        peephole->offsets[next] = peephole->count;
+        emitOptimized(peephole, OP_GET_LOCAL_PROPERTY, line);
+        peephole->fusedCount++;
+        emitOptimized(peephole, chunk->code[offset + 1], line);
+        for (int i = 1; i < 4; i++) {
+            emitOptimized(peephole, chunk->code[next + i], line);
+        }
+        return next + 4;
+    }
+
+    if (opCode == OP_GET_LOCAL && nextOpCode == OP_GET_LOCAL && fusibleOpCode(peephole, next + 2) != OP_GET_PROPERTY) {
+        peephole->offsets[next] = peephole->count;
+        emitOptimized(peephole, OP_GET_LOCAL_LOCAL, line);
+        peephole->fusedCount++;
+        emitOptimized(peephole, chunk->code[offset + 1], line);
+        emitOptimized(peephole, chunk->code[next + 1], line);
+        return next + 2;
+    }
+
+    if (opCode == OP_JUMP_IF_FALSE && nextOpCode == OP_POP) {
+        int target = next + readShort(chunk, offset + 1);
+        if (target < chunk->count && chunk->code[target] == OP_POP) {
+            peephole->offsets[next] = peephole->count;
+            addFixup(peephole, FIXUP_FORWARD, peephole->count + 1, target + 1);
+            emitOptimized(peephole, OP_POP_JUMP_IF_FALSE, line);
+            peephole->fusedCount++;
+            emitOptimized(peephole, 0xff, line);
+            emitOptimized(peephole, 0xff, line);
+            return next + 1;
+        }
+    }
+
+    return -1;
+}
+
+int peepholeOptimize(VM* vm, Chunk* chunk) {
+    int count = chunk->count;
+    Peephole peephole;
+    peephole.chunk = chunk;
+    peephole.isTarget = ALLOCATE(bool, count + 1, GC_GENERATION_TYPE_PERMANENT);
+    peephole.offsets = ALLOCATE(int, count + 1, GC_GENERATION_TYPE_PERMANENT);
+    peephole.code = ALLOCATE(uint8_t, count, GC_GENERATION_TYPE_PERMANENT);
+    peephole.lines = ALLOCATE(int, count, GC_GENERATION_TYPE_PERMANENT);
+    peephole.fixups = ALLOCATE(JumpFixup, count, GC_GENERATION_TYPE_PERMANENT);
+    peephole.count = 0;
+    peephole.fixupCount = 0;
+    peephole.fusedCount = 0;
+    memset(peephole.isTarget, 0, sizeof(bool) * ((size_t)count + 1));
+
+    markJumpTargets(chunk, peephole.isTarget);
+    int offset = 0;
+    while (offset < count) {
+        int length = opCodeOffset(chunk, offset);
+        peephole.offsets[offset] = peephole.count;
+        int next = fuseInstruction(&peephole, offset, length);
+
+        if (next < 0) {
+            copyInstruction(&peephole, offset, length);
+            next = offset + length;
+        }
+        offset = next;
+    }
+    peephole.offsets[count] = peephole.count;
+    applyFixups(&peephole);
+
+    memcpy(chunk->code, peephole.code, peephole.count);
+    chunk->count = peephole.count;
+    compactLines(chunk, peephole.lines);
+
+    FREE_ARRAY(bool, peephole.isTarget, count + 1, GC_GENERATION_TYPE_PERMANENT);
+    FREE_ARRAY(int, peephole.offsets, count + 1, GC_GENERATION_TYPE_PERMANENT);
+    FREE_ARRAY(uint8_t, peephole.code, count, GC_GENERATION_TYPE_PERMANENT);
+    FREE_ARRAY(int, peephole.lines, count, GC_GENERATION_TYPE_PERMANENT);
+    FREE_ARRAY(JumpFixup, peephole.fixups, count, GC_GENERATION_TYPE_PERMANENT);
+    return peephole.fusedCount;
+}
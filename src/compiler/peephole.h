@@ -0,0 +1,9 @@
+#pragma once
+#ifndef clox_peephole_h
+#define clox_peephole_h
+
+#include "chunk.h"
+
+int peepholeOptimize(VM* vm, Chunk* chunk);
+
+#endif // !clox_peephole_h
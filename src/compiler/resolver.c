@@ -1256,7 +1256,7 @@ static void resolveUsingStatement(Resolver* resolver, Ast* ast) {
     if (!isNativeNamespace(fullName)) {
         ObjString* filePath = locateSourceFileFromFullName(resolver->vm, fullName);
         if (sourceFileExists(filePath)) {
-            loadModule(resolver->vm, filePath);
+            loadModule(resolver->vm, filePath, true);
         }
         else {
             ObjString* directoryPath = locateSourceDirectoryFromFullName(resolver->vm, fullName);
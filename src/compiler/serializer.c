@@ -0,0 +1,551 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "serializer.h"
+#include "../common/os.h"
+#include "../vm/hash.h"
+#include "../vm/memory.h"
+#include "../vm/string.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+typedef enum {
+    BYTECODE_VALUE_NIL,
+    BYTECODE_VALUE_FALSE,
+    BYTECODE_VALUE_TRUE,
+    BYTECODE_VALUE_INT,
+    BYTECODE_VALUE_FLOAT,
+    BYTECODE_VALUE_STRING,
+    BYTECODE_VALUE_FUNCTION
+} BytecodeValueType;
+
+typedef struct {
+    uint8_t* bytes;
+    size_t count;
+    size_t capacity;
+    bool hadError;
+} BytecodeWriter;
+
+typedef struct {
+    VM* vm;
+    const uint8_t* current;
+    const uint8_t* end;
+    bool hadError;
+} BytecodeReader;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} MappedFile;
+
+static bool mapFile(const char* path, MappedFile* mappedFile) {
+#ifdef _WIN32
+    mappedFile->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mappedFile->file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mappedFile->file, &size) || size.QuadPart == 0) {
+        CloseHandle(mappedFile->file);
+        return false;
+    }
+
+    mappedFile->mapping = CreateFileMappingA(mappedFile->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappedFile->mapping == NULL) {
+        CloseHandle(mappedFile->file);
+        return false;
+    }
+
+    mappedFile->data = (const uint8_t*)MapViewOfFile(mappedFile->mapping, FILE_MAP_READ, 0, 0, 0);
+    mappedFile->size = (size_t)size.QuadPart;
+    if (mappedFile->data == NULL) {
+        CloseHandle(mappedFile->mapping);
+        CloseHandle(mappedFile->file);
+        return false;
+    }
+    return true;
+#else
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) return false;
+
+    struct stat fileStat;
+    if (fstat(descriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(descriptor);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED) return false;
+
+    mappedFile->data = (const uint8_t*)data;
+    mappedFile->size = (size_t)fileStat.st_size;
+    return true;
+#endif
+}
+
+static void unmapFile(MappedFile* mappedFile) {
+#ifdef _WIN32
+    UnmapViewOfFile(mappedFile->data);
+    CloseHandle(mappedFile->mapping);
+    CloseHandle(mappedFile->file);
+#else
+    munmap((void*)mappedFile->data, mappedFile->size);
+#endif
+}
+
+typedef struct {
+    char name[UINT8_MAX];
+    double time;
+    int64_t size;
+} CacheEntry;
+
+static bool hasCacheDirectory(VM* vm) {
+    return vm->config.cachePath != NULL && vm->config.cachePath[0] != '\0';
+}
+
+static int getCacheDirectory(VM* vm, char* chars) {
+    const char* path = vm->config.cachePath;
+    size_t length = strlen(path);
+    bool hasSeparator = path[length - 1] == '/' || path[length - 1] == '\\';
+    return snprintf(chars, UINT8_MAX, hasSeparator ? "%s" : "%s/", path);
+}
+
+static bool locateCachedBytecode(VM* vm, const BytecodeHeader* header, const char* source, int length, char* bytecodePath) {
+    char settings[UINT8_MAX];
+    int settingsLength = snprintf(settings, UINT8_MAX, "%u|%s|%u", header->version, vm->config.version, header->settings);
+
+    Sha256 sha256;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    initSha256(&sha256);
+    updateSha256(&sha256, source, length);
+    updateSha256(&sha256, settings, settingsLength);
+    finalSha256(&sha256, digest);
+
+    int pathLength = getCacheDirectory(vm, bytecodePath);
+    for (int i = 0; i < SHA256_DIGEST_SIZE && pathLength < UINT8_MAX; i++) {
+        pathLength += snprintf(bytecodePath + pathLength, UINT8_MAX - pathLength, "%02x", digest[i]);
+    }
+    if (pathLength < UINT8_MAX) pathLength += snprintf(bytecodePath + pathLength, UINT8_MAX - pathLength, ".loxo");
+    return pathLength < UINT8_MAX;
+}
+
+static uint32_t compilerSettings(VM* vm) {
+    return (uint32_t)vm->config.optimizeAst
+        | ((uint32_t)vm->config.flagUnusedImport << 1)
+        | ((uint32_t)vm->config.flagUnusedVariable << 3)
+        | ((uint32_t)vm->config.flagMutableVariable << 5);
+}
+
+static bool locateBytecode(VM* vm, ObjString* sourcePath, const char* source, char* bytecodePath, BytecodeHeader* header) {
+    int length = (int)strlen(source);
+    memset(header, 0, sizeof(BytecodeHeader));
+    memcpy(header->magic, BYTECODE_MAGIC, 4);
+    header->version = BYTECODE_VERSION;
+    header->settings = compilerSettings(vm);
+    header->sourceHash = hashString(source, length);
+    header->sourceLength = (uint32_t)length;
+    header->sourceTime = 0;
+    if (hasCacheDirectory(vm)) return locateCachedBytecode(vm, header, source, length, bytecodePath);
+
+    struct stat fileStat;
+    if (stat(sourcePath->chars, &fileStat) != 0) return false;
+    header->sourceTime = (int64_t)fileStat.st_mtime;
+    return snprintf(bytecodePath, UINT8_MAX, "%so", sourcePath->chars) < UINT8_MAX;
+}
+
+static void touchCacheEntry(VM* vm, const char* bytecodePath) {
+    uv_fs_t fsUtime;
+    double now = (double)time(NULL);
+    uv_fs_utime(vm->eventLoop, &fsUtime, bytecodePath, now, now, NULL);
+    uv_fs_req_cleanup(&fsUtime);
+}
+
+static int compareCacheEntries(const void* entry, const void* entry2) {
+    double time = ((const CacheEntry*)entry)->time;
+    double time2 = ((const CacheEntry*)entry2)->time;
+    return (time > time2) - (time < time2);
+}
+
+static void evictCacheEntries(VM* vm) {
+    char directory[UINT8_MAX];
+    char path[UINT8_MAX];
+    int directoryLength = getCacheDirectory(vm, directory);
+    if (directoryLength >= UINT8_MAX) return;
+
+    uv_fs_t fsScandir;
+    if (uv_fs_scandir(vm->eventLoop, &fsScandir, directory, 0, NULL) < 0) {
+        uv_fs_req_cleanup(&fsScandir);
+        return;
+    }
+
+    CacheEntry* entries = NULL;
+    int count = 0;
+    int capacity = 0;
+    int64_t totalSize = 0;
+    uv_dirent_t dirent;
+
+    while (uv_fs_scandir_next(&fsScandir, &dirent) != UV_EOF) {
+        size_t nameLength = strlen(dirent.name);
+        if (nameLength < 5 || strcmp(dirent.name + nameLength - 5, ".loxo") != 0) continue;
+        if (snprintf(path, UINT8_MAX, "%s%s", directory, dirent.name) >= UINT8_MAX) continue;
+
+        uv_fs_t fsStat;
+        if (uv_fs_stat(vm->eventLoop, &fsStat, path, NULL) == 0) {
+            if (count == capacity) {
+                capacity = capacity < 8 ? 8 : capacity * 2;
+                CacheEntry* newEntries = (CacheEntry*)realloc(entries, sizeof(CacheEntry) * capacity);
+                if (newEntries == NULL) break;
+                entries = newEntries;
+            }
+
+            CacheEntry* entry = &entries[count++];
+            snprintf(entry->name, UINT8_MAX, "%s", path);
+            entry->time = fsStat.statbuf.st_mtim.tv_sec + fsStat.statbuf.st_mtim.tv_nsec / 1e9;
+            entry->size = (int64_t)fsStat.statbuf.st_size;
+            totalSize += entry->size;
+        }
+        uv_fs_req_cleanup(&fsStat);
+    }
+    uv_fs_req_cleanup(&fsScandir);
+
+    if (totalSize > (int64_t)vm->config.cacheMaxSize) {
+        qsort(entries, count, sizeof(CacheEntry), compareCacheEntries);
+        for (int i = 0; i < count && totalSize > (int64_t)vm->config.cacheMaxSize; i++) {
+            uv_fs_t fsUnlink;
+            if (uv_fs_unlink(vm->eventLoop, &fsUnlink, entries[i].name, NULL) == 0) totalSize -= entries[i].size;
+            uv_fs_req_cleanup(&fsUnlink);
+        }
+    }
+    free(entries);
+}
+
+static void writeBytes(BytecodeWriter* writer, const void* bytes, size_t count) {
+    if (writer->count + count > writer->capacity) {
+        size_t capacity = writer->capacity < 256 ? 256 : writer->capacity;
+        while (capacity < writer->count + count) capacity *= 2;
+        uint8_t* newBytes = (uint8_t*)realloc(writer->bytes, capacity);
+        if (newBytes == NULL) {
+            writer->hadError = true;
+            return;
+        }
+        writer->bytes = newBytes;
+        writer->capacity = capacity;
+    }
+
+    memcpy(writer->bytes + writer->count, bytes, count);
+    writer->count += count;
+}
+
+static void writeByte(BytecodeWriter* writer, uint8_t byte) {
+    writeBytes(writer, &byte, 1);
+}
+
+static void writeInt(BytecodeWriter* writer, int32_t value) {
+    writeBytes(writer, &value, sizeof(int32_t));
+}
+
+static void writeString(BytecodeWriter* writer, ObjString* string) {
+    writeInt(writer, string->length);
+    writeBytes(writer, string->chars, string->length);
+}
+
+static void writeFunction(BytecodeWriter* writer, ObjFunction* function);
+
+static void writeValue(BytecodeWriter* writer, Value value) {
+    if (IS_NIL(value)) writeByte(writer, BYTECODE_VALUE_NIL);
+    else if (IS_BOOL(value)) writeByte(writer, AS_BOOL(value) ? BYTECODE_VALUE_TRUE : BYTECODE_VALUE_FALSE);
+    else if (IS_INT(value)) {
+        writeByte(writer, BYTECODE_VALUE_INT);
+        writeInt(writer, AS_INT(value));
+    }
+    else if (IS_FLOAT(value)) {
+        double number = AS_FLOAT(value);
+        writeByte(writer, BYTECODE_VALUE_FLOAT);
+        writeBytes(writer, &number, sizeof(double));
+    }
+    else if (IS_STRING(value)) {
+        writeByte(writer, BYTECODE_VALUE_STRING);
+        writeString(writer, AS_STRING(value));
+    }
+    else if (IS_FUNCTION(value)) {
+        writeByte(writer, BYTECODE_VALUE_FUNCTION);
+        writeFunction(writer, AS_FUNCTION(value));
+    }
+    else writer->hadError = true;
+}
+
+static void writeFunction(BytecodeWriter* writer, ObjFunction* function) {
+    Chunk* chunk = &function->chunk;
+    for (int offset = 0; offset < chunk->count; offset += opCodeOffset(chunk, offset)) {
+        if (chunk->code[offset] == OP_TYPE) {
+            writer->hadError = true;
+            return;
+        }
+    }
+
+    writeByte(writer, function->name != NULL);
+    if (function->name != NULL) writeString(writer, function->name);
+    writeInt(writer, function->arity);
+    writeInt(writer, function->upvalueCount);
+    writeByte(writer, function->isGenerator);
+    writeByte(writer, function->isAsync);
+    writeInt(writer, function->interceptor);
+
+    writeInt(writer, chunk->count);
+    writeBytes(writer, chunk->code, chunk->count);
+    writeInt(writer, chunk->lineCount);
+    writeBytes(writer, chunk->lines, sizeof(LineStart) * chunk->lineCount);
+    writeInt(writer, chunk->handlerCount);
+    writeBytes(writer, chunk->handlers, sizeof(ExceptionHandler) * chunk->handlerCount);
+
+    writeInt(writer, chunk->constants.count);
+    for (int i = 0; i < chunk->constants.count; i++) {
+        writeValue(writer, chunk->constants.values[i]);
+    }
+
+    writeInt(writer, chunk->identifiers.count);
+    for (int i = 0; i < chunk->identifiers.count; i++) {
+        writeValue(writer, chunk->identifiers.values[i]);
+    }
+    writeInt(writer, chunk->inlineCacheCount);
+}
+
+static void writeGlobals(BytecodeWriter* writer, IDMap* indexes, int start, int count) {
+    if (count <= start) {
+        writeInt(writer, 0);
+        return;
+    }
+
+    ObjString** names = (ObjString**)calloc((size_t)(count - start), sizeof(ObjString*));
+    if (names == NULL) {
+        writer->hadError = true;
+        return;
+    }
+
+    int nameCount = 0;
+    for (int i = 0; i < indexes->capacity; i++) {
+        IDEntry* entry = &indexes->entries[i];
+        if (entry->key != NULL && entry->value >= start && entry->value < count) {
+            names[entry->value - start] = entry->key;
+            nameCount++;
+        }
+    }
+
+    writeInt(writer, nameCount);
+    for (int i = 0; i < count - start; i++) {
+        if (names[i] != NULL) writeString(writer, names[i]);
+    }
+    free(names);
+}
+
+static const void* readBytes(BytecodeReader* reader, size_t count) {
+    if (reader->hadError || (size_t)(reader->end - reader->current) < count) {
+        reader->hadError = true;
+        return NULL;
+    }
+
+    const void* bytes = reader->current;
+    reader->current += count;
+    return bytes;
+}
+
+static uint8_t readByte(BytecodeReader* reader) {
+    const uint8_t* byte = (const uint8_t*)readBytes(reader, 1);
+    return byte == NULL ? 0 : *byte;
+}
+
+static int32_t readInt(BytecodeReader* reader) {
+    int32_t value = 0;
+    const void* bytes = readBytes(reader, sizeof(int32_t));
+    if (bytes != NULL) memcpy(&value, bytes, sizeof(int32_t));
+    return value;
+}
+
+static ObjString* readString(BytecodeReader* reader) {
+    int length = readInt(reader);
+    const char* chars = (const char*)readBytes(reader, length);
+    return chars == NULL ? NULL : copyStringPerma(reader->vm, chars, length);
+}
+
+static ObjFunction* readFunction(BytecodeReader* reader);
+
+static Value readValue(BytecodeReader* reader) {
+    switch (readByte(reader)) {
+        case BYTECODE_VALUE_NIL: return NIL_VAL;
+        case BYTECODE_VALUE_FALSE: return BOOL_VAL(false);
+        case BYTECODE_VALUE_TRUE: return BOOL_VAL(true);
+        case BYTECODE_VALUE_INT: return INT_VAL(readInt(reader));
+        case BYTECODE_VALUE_FLOAT: {
+            double number = 0;
+            const void* bytes = readBytes(reader, sizeof(double));
+            if (bytes != NULL) memcpy(&number, bytes, sizeof(double));
+            return FLOAT_VAL(number);
+        }
+        case BYTECODE_VALUE_STRING: {
+            ObjString* string = readString(reader);
+            return string == NULL ? NIL_VAL : OBJ_VAL(string);
+        }
+        case BYTECODE_VALUE_FUNCTION: {
+            ObjFunction* function = readFunction(reader);
+            return function == NULL ? NIL_VAL : OBJ_VAL(function);
+        }
+        default:
+            reader->hadError = true;
+            return NIL_VAL;
+    }
+}
+
+static ObjFunction* readFunction(BytecodeReader* reader) {
+    VM* vm = reader->vm;
+    ObjString* name = readByte(reader) ? readString(reader) : NULL;
+    if (reader->hadError) return NULL;
+
+    ObjFunction* function = newFunction(vm, name, false);
+    push(vm, OBJ_VAL(function));
+    Chunk* chunk = &function->chunk;
+    function->arity = readInt(reader);
+    function->upvalueCount = readInt(reader);
+    function->isGenerator = readByte(reader);
+    function->isAsync = readByte(reader);
+    function->interceptor = (InterceptorType)readInt(reader);
+
+    int count = readInt(reader);
+    const uint8_t* code = (const uint8_t*)readBytes(reader, count);
+    if (code != NULL) {
+        chunk->code = GROW_ARRAY(uint8_t, NULL, 0, count, chunk->generation);
+        chunk->capacity = count;
+        chunk->count = count;
+        memcpy(chunk->code, code, count);
+    }
+
+    int lineCount = readInt(reader);
+    const void* lines = readBytes(reader, sizeof(LineStart) * lineCount);
+    if (lines != NULL) {
+        chunk->lines = GROW_ARRAY(LineStart, NULL, 0, lineCount, chunk->generation);
+        chunk->lineCapacity = lineCount;
+        chunk->lineCount = lineCount;
+        memcpy(chunk->lines, lines, sizeof(LineStart) * lineCount);
+    }
+
+    int handlerCount = readInt(reader);
+    const ExceptionHandler* handlers = (const ExceptionHandler*)readBytes(reader, sizeof(ExceptionHandler) * handlerCount);
+    for (int i = 0; handlers != NULL && i < handlerCount; i++) {
+        int handler = addExceptionHandler(vm, chunk, 0);
+        memcpy(&chunk->handlers[handler], &handlers[i], sizeof(ExceptionHandler));
+    }
+
+    int constantCount = readInt(reader);
+    for (int i = 0; i < constantCount && !reader->hadError; i++) {
+        Value constant = readValue(reader);
+        PROCESS_WRITE_BARRIER((Obj*)function, constant);
+        addConstant(vm, chunk, constant);
+    }
+
+    int identifierCount = readInt(reader);
+    for (int i = 0; i < identifierCount && !reader->hadError; i++) {
+        Value identifier = readValue(reader);
+        PROCESS_WRITE_BARRIER((Obj*)function, identifier);
+        addIdentifier(vm, chunk, identifier);
+    }
+
+    int inlineCacheCount = readInt(reader);
+    for (int i = 0; i < inlineCacheCount && !reader->hadError; i++) {
+        addInlineCache(vm, chunk);
+    }
+
+    pop(vm);
+    return reader->hadError ? NULL : function;
+}
+
+static void readGlobals(BytecodeReader* reader, IDMap* indexes, ValueArray* fields) {
+    VM* vm = reader->vm;
+    int count = readInt(reader);
+    for (int i = 0; i < count && !reader->hadError; i++) {
+        ObjString* name = readString(reader);
+        if (name == NULL) return;
+
+        int index;
+        if (idMapGet(indexes, name, &index)) continue;
+        idMapSet(vm, indexes, name, fields->count);
+        valueArrayWrite(vm, fields, NIL_VAL);
+    }
+}
+
+ObjFunction* loadBytecode(VM* vm, ObjString* sourcePath, const char* source) {
+    BytecodeHeader expected;
+    char bytecodePath[UINT8_MAX];
+    if (!locateBytecode(vm, sourcePath, source, bytecodePath, &expected)) return NULL;
+
+    MappedFile mappedFile;
+    if (!mapFile(bytecodePath, &mappedFile)) return NULL;
+
+    BytecodeReader reader = { .vm = vm, .current = mappedFile.data, .end = mappedFile.data + mappedFile.size, .hadError = false };
+    const BytecodeHeader* header = (const BytecodeHeader*)readBytes(&reader, sizeof(BytecodeHeader));
+    ObjFunction* function = NULL;
+
+    if (header != NULL && memcmp(header, &expected, sizeof(BytecodeHeader)) == 0) {
+        readGlobals(&reader, &vm->currentModule->valIndexes, &vm->currentModule->valFields);
+        readGlobals(&reader, &vm->currentModule->varIndexes, &vm->currentModule->varFields);
+        function = readFunction(&reader);
+        if (reader.current != reader.end) function = NULL;
+    }
+
+    unmapFile(&mappedFile);
+    if (function != NULL && hasCacheDirectory(vm)) touchCacheEntry(vm, bytecodePath);
+    return function;
+}
+
+bool saveBytecode(VM* vm, ObjString* sourcePath, const char* source, ObjFunction* function, int valStart, int varStart) {
+    BytecodeHeader header;
+    char bytecodePath[UINT8_MAX];
+    if (!locateBytecode(vm, sourcePath, source, bytecodePath, &header)) return false;
+
+    BytecodeWriter writer = { .bytes = NULL, .count = 0, .capacity = 0, .hadError = false };
+    writeBytes(&writer, &header, sizeof(BytecodeHeader));
+    writeGlobals(&writer, &vm->currentModule->valIndexes, valStart, vm->currentModule->valFields.count);
+    writeGlobals(&writer, &vm->currentModule->varIndexes, varStart, vm->currentModule->varFields.count);
+    writeFunction(&writer, function);
+
+    if (writer.hadError) {
+        free(writer.bytes);
+        return false;
+    }
+
+    if (hasCacheDirectory(vm)) {
+        uv_fs_t fsMkdir;
+        uv_fs_mkdir(vm->eventLoop, &fsMkdir, vm->config.cachePath, S_IREAD | S_IWRITE | S_IEXEC, NULL);
+        uv_fs_req_cleanup(&fsMkdir);
+    }
+
+    char tempPath[UINT8_MAX + 4];
+    FILE* file = NULL;
+    if (snprintf(tempPath, sizeof(tempPath), "%s.tmp", bytecodePath) < (int)sizeof(tempPath)) fopen_s(&file, tempPath, "wb");
+    if (file == NULL) {
+        free(writer.bytes);
+        return false;
+    }
+
+    bool written = fwrite(writer.bytes, sizeof(uint8_t), writer.count, file) == writer.count;
+    fclose(file);
+    free(writer.bytes);
+
+    if (written) {
+        remove(bytecodePath);
+        written = rename(tempPath, bytecodePath) == 0;
+    }
+    if (!written) remove(tempPath);
+    else if (hasCacheDirectory(vm)) evictCacheEntries(vm);
+    return written;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef clox_serializer_h
+#define clox_serializer_h
+
+#include "../vm/vm.h"
+
+#define BYTECODE_MAGIC "LOXO"
+#define BYTECODE_VERSION 3
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t settings;
+    uint32_t sourceHash;
+    uint32_t sourceLength;
+    int64_t sourceTime;
+} BytecodeHeader;
+
+ObjFunction* loadBytecode(VM* vm, ObjString* sourcePath, const char* source);
+bool saveBytecode(VM* vm, ObjString* sourcePath, const char* source, ObjFunction* function, int valStart, int varStart);
+
+#endif // !clox_serializer_h
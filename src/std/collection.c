@@ -168,9 +168,13 @@ static bool linkAddBefore(VM* vm, ObjInstance* linkedList, Value element, ObjNod
         ObjNode* pred = succ->prev;
         ObjNode* new = newNode(vm, element, pred, succ);
         push(vm, OBJ_VAL(new));
+        PROCESS_WRITE_BARRIER((Obj*)succ, OBJ_VAL(new));
         succ->prev = new;
         if (pred == NULL) setObjField(vm, linkedList, "first", OBJ_VAL(new));
-        else pred->next = new;
+        else {
+            PROCESS_WRITE_BARRIER((Obj*)pred, OBJ_VAL(new));
+            pred->next = new;
+        }
         pop(vm);
         collectionLengthIncrement(vm, linkedList);
         return true;
@@ -184,7 +188,10 @@ static void linkAddFirst(VM* vm, ObjInstance* linkedList, Value element) {
     push(vm, OBJ_VAL(new));
     setObjField(vm, linkedList, "first", OBJ_VAL(new));
     if (first == NULL) setObjField(vm, linkedList, "last", OBJ_VAL(new));
-    else first->prev = new;
+    else {
+        PROCESS_WRITE_BARRIER((Obj*)first, OBJ_VAL(new));
+        first->prev = new;
+    }
     pop(vm);
     collectionLengthIncrement(vm, linkedList);
 }
@@ -196,7 +203,10 @@ static void linkAddLast(VM* vm, ObjInstance* linkedList, Value element) {
     push(vm, OBJ_VAL(new));
     setObjField(vm, linkedList, "last", OBJ_VAL(new));
     if (last == NULL) setObjField(vm, linkedList, "first", OBJ_VAL(new));
-    else last->next = new;
+    else {
+        PROCESS_WRITE_BARRIER((Obj*)last, OBJ_VAL(new));
+        last->next = new;
+    }
     pop(vm);
     collectionLengthIncrement(vm, linkedList);
 }
@@ -415,6 +425,7 @@ LOX_METHOD(Array, __init__) {
 
 LOX_METHOD(Array, add) {
     ASSERT_ARG_COUNT("Array::add(element)", 1);
+    PROCESS_WRITE_BARRIER(AS_OBJ(receiver), args[0]);
     valueArrayWrite(vm, &AS_ARRAY(receiver)->elements, args[0]);
     RETURN_OBJ(receiver);
 }
@@ -422,6 +433,10 @@ LOX_METHOD(Array, add) {
 LOX_METHOD(Array, addAll) {
     ASSERT_ARG_COUNT("Array::addAll(array)", 1);
     ASSERT_ARG_TYPE("Array::addAll(array)", 0, Array);
+    ObjArray* array = AS_ARRAY(args[0]);
+    for (int i = 0; i < array->elements.count; i++) {
+        PROCESS_WRITE_BARRIER(AS_OBJ(receiver), array->elements.values[i]);
+    }
     valueArrayAddAll(vm, &AS_ARRAY(args[0])->elements, &AS_ARRAY(receiver)->elements);
     RETURN_NIL;
 }
@@ -507,6 +522,7 @@ LOX_METHOD(Array, fill) {
     ASSERT_ARG_TYPE("Array::fill(num, value)", 0, Int);
     ObjArray* array = AS_ARRAY(receiver);
     int num = AS_INT(args[0]);
+    PROCESS_WRITE_BARRIER((Obj*)array, args[1]);
     for (int i = 0; i < num; i++) {
         valueArrayWrite(vm, &array->elements, args[1]);
     }
@@ -535,6 +551,7 @@ LOX_METHOD(Array, insertAt) {
     ObjArray* self = AS_ARRAY(receiver);
     int index = AS_INT(args[0]);
     ASSERT_INDEX_WITHIN_BOUNDS("Array::insertAt(index, element)", index, 0, self->elements.count, 0);
+    PROCESS_WRITE_BARRIER((Obj*)self, args[1]);
     valueArrayInsert(vm, &self->elements, index, args[1]);
     RETURN_VAL(args[1]);
 }
@@ -565,6 +582,7 @@ LOX_METHOD(Array, putAt) {
     ASSERT_ARG_COUNT("Array::putAt(index, element)", 2);
     ASSERT_ARG_TYPE("Array::putAt(index, element)", 0, Int);
     ObjArray* self = AS_ARRAY(receiver);
+    PROCESS_WRITE_BARRIER((Obj*)self, args[1]);
     valueArrayPut(vm, &self->elements, AS_INT(args[0]), args[1]);
     RETURN_OBJ(receiver);
 }
@@ -652,6 +670,7 @@ LOX_METHOD(Array, __setSubscript__) {
     ObjArray* self = AS_ARRAY(receiver);
     int index = AS_INT(args[0]);
     ASSERT_INDEX_WITHIN_BOUNDS("Array::[]=(index, element)", index, 0, self->elements.count, 0);
+    PROCESS_WRITE_BARRIER((Obj*)self, args[1]);
     self->elements.values[index] = args[1];
     if (index == self->elements.count) self->elements.count++;
     RETURN_OBJ(receiver);
@@ -1415,6 +1434,7 @@ LOX_METHOD(LinkedList, putAt) {
 
     ObjNode* node = linkNode(vm, self, index);
     Value old = node->element;
+    PROCESS_WRITE_BARRIER((Obj*)node, args[1]);
     node->element = args[1];
     RETURN_VAL(old);
 }
@@ -1644,6 +1664,7 @@ LOX_METHOD(Queue, enqueue) {
         setObjField(vm, self, "last", OBJ_VAL(new));
     }
     else {
+        PROCESS_WRITE_BARRIER((Obj*)last, OBJ_VAL(new));
         last->next = new;
         setObjField(vm, self, "last", OBJ_VAL(new));
     }
@@ -961,10 +961,14 @@ LOX_METHOD(Method, __init__) {
         THROW_EXCEPTION_FMT(clox.std.lang.UnsupportedOperationException, "Method %s already exists in behavior %s.", name->chars, behavior->fullName->chars);
     }
     tableSet(vm, &behavior->methods, name, OBJ_VAL(closure));
+    PROCESS_WRITE_BARRIER((Obj*)behavior, OBJ_VAL(closure));
+    behavior->methodVersion++;
 
     self->behavior = behavior;
     self->closure = closure;
     self->closure->function->name = name;
+    PROCESS_WRITE_BARRIER((Obj*)self, OBJ_VAL(closure));
+    PROCESS_WRITE_BARRIER((Obj*)closure->function, OBJ_VAL(name));
     RETURN_OBJ(self);
 }
 
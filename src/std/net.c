@@ -56,7 +56,7 @@ LOX_METHOD(Domain, toString) {
 LOX_METHOD(HTTPClient, __init__) {
     ASSERT_ARG_COUNT("HTTPClient::__init__()", 0);
     ObjInstance* self = AS_INSTANCE(receiver);
-    CURLMData* curlMData = httpCURLMData(vm, curl_multi_init(), ALLOCATE_STRUCT(uv_timer_t));
+    CURLMData* curlMData = httpCURLMData(vm, httpCURLMInit(), ALLOCATE_STRUCT(uv_timer_t));
     if (curlMData == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a HTTP Client.");
     curlMData->timer->data = curlMData;
 
@@ -84,7 +84,7 @@ LOX_METHOD(HTTPClient, delete) {
     ASSERT_ARG_COUNT("HTTPClient::delete(url)", 1);
     ASSERT_ARG_INSTANCE_OF_ANY("HTTPClient::delete(url)", 0, clox.std.lang.String, clox.std.net.URL);
     ObjString* url = httpRawURL(vm, args[0]);
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a DELETE request using CURL.");
 
     CURLResponse curlResponse;
@@ -119,7 +119,7 @@ LOX_METHOD(HTTPClient, download) {
 
     ObjString* src = httpRawURL(vm, args[0]);
     ObjString* dest = AS_STRING(args[1]);
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a request to download file using CURL.");
 
     CURLcode curlCode = httpDownloadFile(vm, src, dest, curl);
@@ -151,7 +151,7 @@ LOX_METHOD(HTTPClient, get) {
     ASSERT_ARG_COUNT("HTTPClient::get(url)", 1);
     ASSERT_ARG_INSTANCE_OF_ANY("HTTPClient::get(url)", 0, clox.std.lang.String, clox.std.net.URL);
     ObjString* url = httpRawURL(vm, args[0]);
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a GET request using CURL.");
 
     CURLResponse curlResponse;
@@ -183,7 +183,7 @@ LOX_METHOD(HTTPClient, head) {
     ASSERT_ARG_COUNT("HTTPClient::head(url)", 1);
     ASSERT_ARG_INSTANCE_OF_ANY("HTTPClient::head(url)", 0, clox.std.lang.String, clox.std.net.URL);
     ObjString* url = httpRawURL(vm, args[0]);
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a HEAD request using CURL.");
 
     CURLResponse curlResponse;
@@ -216,7 +216,7 @@ LOX_METHOD(HTTPClient, options) {
     ASSERT_ARG_COUNT("HTTPClient::options(url)", 1);
     ASSERT_ARG_INSTANCE_OF_ANY("HTTPClient::options(url)", 0, clox.std.lang.String, clox.std.net.URL);
     ObjString* url = httpRawURL(vm, args[0]);
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate an OPTIONS request using CURL.");
 
     CURLResponse curlResponse;
@@ -251,7 +251,7 @@ LOX_METHOD(HTTPClient, patch) {
     ObjString* url = httpRawURL(vm, args[0]);
     ObjDictionary* data = AS_DICTIONARY(args[1]);
 
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a PATCH request using CURL.");
     CURLResponse curlResponse;
     CURLcode curlCode = httpSendRequest(vm, url, HTTP_PATCH, data, curl, &curlResponse);
@@ -287,7 +287,7 @@ LOX_METHOD(HTTPClient, post) {
     ObjString* url = httpRawURL(vm, args[0]);
     ObjDictionary* data = AS_DICTIONARY(args[1]);
 
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a POST request using CURL.");
     CURLResponse curlResponse;
     CURLcode curlCode = httpSendRequest(vm, url, HTTP_POST, data, curl, &curlResponse);
@@ -323,7 +323,7 @@ LOX_METHOD(HTTPClient, put) {
     ObjString* url = httpRawURL(vm, args[0]);
     ObjDictionary* data = AS_DICTIONARY(args[1]);
 
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate a PUT request using CURL.");
     CURLResponse curlResponse;
     CURLcode curlCode = httpSendRequest(vm, url, HTTP_PUT, data, curl, &curlResponse);
@@ -355,7 +355,7 @@ LOX_METHOD(HTTPClient, putAsync) {
 LOX_METHOD(HTTPClient, send) {
     ASSERT_ARG_COUNT("HTTPClient::send(request)", 1);
     ASSERT_ARG_INSTANCE_OF("HTTPClient::send(request)", 0, clox.std.net.HTTPRequest);
-    CURL* curl = curl_easy_init();
+    CURL* curl = httpCURLInit();
     if (curl == NULL) THROW_EXCEPTION(clox.std.net.HTTPException, "Failed to initiate an HTTP request using CURL.");
 
     ObjInstance* request = AS_INSTANCE(args[0]);
@@ -26,7 +26,9 @@ void initClass(VM* vm, ObjClass* klass, ObjString* name, ObjClass* metaclass, Be
     klass->superclass = NULL;
     klass->isNative = false;
     klass->interceptors = 0;
+    klass->methodVersion = 0;
     klass->defaultShapeID = 0;
+    klass->operatorVersion = -1;
 
     if (!klass->namespace->isRoot) {
         char chars[UINT8_MAX];
@@ -59,7 +61,9 @@ void initTrait(VM* vm, ObjClass* trait, ObjString* name) {
     trait->superclass = NULL;
     trait->isNative = false;
     trait->interceptors = 0;
+    trait->methodVersion = 0;
     trait->defaultShapeID = 0;
+    trait->operatorVersion = -1;
 
     if (!trait->namespace->isRoot) {
         char chars[UINT8_MAX];
@@ -155,6 +159,7 @@ static void inheritTraits(VM* vm, ObjClass* subclass, ObjClass* superclass) {
 
 static void inheritMethods(VM* vm, ObjClass* subclass, ObjClass* superclass) {
     tableAddAll(vm, &superclass->methods, &subclass->methods);
+    subclass->methodVersion++;
 }
 
 void inheritSuperclass(VM* vm, ObjClass* subclass, ObjClass* superclass) {
@@ -234,12 +239,16 @@ void implementTraits(VM* vm, ObjClass* klass, ValueArray* traits) {
     for (int i = 0; i < traits->count; i++) {
         ObjClass* trait = AS_CLASS(traits->values[i]);
         tableAddAll(vm, &trait->methods, &klass->methods);
+        klass->interceptors |= trait->interceptors;
     }
+    klass->methodVersion++;
     flattenTraits(vm, klass, traits);
 }
 
 void bindTrait(VM* vm, ObjClass* klass, ObjClass* trait) {
     tableAddAll(vm, &trait->methods, &klass->methods);
+    klass->interceptors |= trait->interceptors;
+    klass->methodVersion++;
     valueArrayWrite(vm, &klass->traits, OBJ_VAL(trait));
     BehaviorTypeInfo* classType = AS_BEHAVIOR_TYPE(typeTableGet(vm->typetab, klass->fullName));
 
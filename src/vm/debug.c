@@ -9,6 +9,12 @@ void disassembleChunk(Chunk* chunk, const char* name) {
     for (int offset = 0; offset < chunk->count;) {
         offset = disassembleInstruction(chunk, offset);
     }
+
+    for (int i = 0; i < chunk->handlerCount; i++) {
+        ExceptionHandler* handler = &chunk->handlers[i];
+        printf("handler %d [%d, %d) %4d -> %d, %d\n", i, handler->startAddress, handler->endAddress,
+            handler->exceptionType, handler->handlerAddress, handler->finallyAddress);
+    }
 }
 
 static int constantInstruction(const char* name, Chunk* chunk, int offset) {
@@ -27,6 +33,15 @@ static int identifierInstruction(const char* name, Chunk* chunk, int offset) {
     return offset + 2;
 }
 
+static int cachedIdentifierInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t identifier = chunk->code[offset + 1];
+    uint16_t inlineCache = (uint16_t)(chunk->code[offset + 2] << 8) | chunk->code[offset + 3];
+    printf("%-16s %4d '", name, identifier);
+    printValue(chunk->identifiers.values[identifier]);
+    printf("' (cache %d)\n", inlineCache);
+    return offset + 4;
+}
+
 static int memberInstruction(const char* name, Chunk* chunk, int offset) {
     uint8_t identifier = chunk->code[offset + 1];
     uint8_t isClass = (bool)chunk->code[offset + 2];
@@ -36,13 +51,14 @@ static int memberInstruction(const char* name, Chunk* chunk, int offset) {
     return offset + 3;
 }
 
-static int invokeInstruction(const char* name, Chunk* chunk, int offset) {
+static int cachedInvokeInstruction(const char* name, Chunk* chunk, int offset) {
     uint8_t identifier = chunk->code[offset + 1];
     uint8_t argCount = chunk->code[offset + 2];
+    uint16_t inlineCache = (uint16_t)(chunk->code[offset + 3] << 8) | chunk->code[offset + 4];
     printf("%-16s (%d args) %4d '", name, argCount, identifier);
     printValue(chunk->identifiers.values[identifier]);
-    printf("'\n");
-    return offset + 3;
+    printf("' (cache %d)\n", inlineCache);
+    return offset + 5;
 }
 
 static int simpleInstruction(const char* name, int offset) {
@@ -56,6 +72,23 @@ static int byteInstruction(const char* name, Chunk* chunk, int offset) {
     return offset + 2;
 }
 
+static int doubleByteInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t slot = chunk->code[offset + 1];
+    uint8_t slot2 = chunk->code[offset + 2];
+    printf("%-16s %4d %4d\n", name, slot, slot2);
+    return offset + 3;
+}
+
+static int localPropertyInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t slot = chunk->code[offset + 1];
+    uint8_t identifier = chunk->code[offset + 2];
+    uint16_t inlineCache = (uint16_t)(chunk->code[offset + 3] << 8) | chunk->code[offset + 4];
+    printf("%-16s %4d %4d '", name, slot, identifier);
+    printValue(chunk->identifiers.values[identifier]);
+    printf("' (cache %d)\n", inlineCache);
+    return offset + 5;
+}
+
 static int jumpInstruction(const char* name, int sign, Chunk* chunk, int offset) {
     uint16_t jump = (uint16_t)(chunk->code[offset + 1] << 8);
     jump |= chunk->code[offset + 2];
@@ -63,13 +96,11 @@ static int jumpInstruction(const char* name, int sign, Chunk* chunk, int offset)
     return offset + 3;
 }
 
-static int exceptionHandlerInstruction(const char* name, Chunk* chunk, int offset) {
-    uint8_t exceptionType = chunk->code[offset + 1];
-    uint16_t handlerAddress = (uint16_t)(chunk->code[offset + 2] << 8);
-    handlerAddress |= chunk->code[offset + 3];
-    uint16_t finallyAddress = (uint16_t)(chunk->code[offset + 4] << 8);
-    finallyAddress |= chunk->code[offset + 5];
-    printf("%-16s %4d -> %d, %d\n", name, exceptionType, handlerAddress, finallyAddress);
+static int forIterInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t slot = chunk->code[offset + 1];
+    uint16_t bodyJump = (uint16_t)(chunk->code[offset + 2] << 8) | chunk->code[offset + 3];
+    uint16_t exitJump = (uint16_t)(chunk->code[offset + 4] << 8) | chunk->code[offset + 5];
+    printf("%-16s %4d %4d -> %d, %d\n", name, slot, offset, offset + 4 + bodyJump, offset + 6 + exitJump);
     return offset + 6;
 }
 
@@ -91,11 +122,12 @@ static int closureInstruction(const char* name, Chunk* chunk, int offset) {
 
 int disassembleInstruction(Chunk* chunk, int offset) {
     printf("%04d ", offset);
-    if (offset > 0 && chunk->lines[offset] == chunk->lines[offset - 1]) {
+    int line = getLine(chunk, offset);
+    if (offset > 0 && line == getLine(chunk, offset - 1)) {
         printf("   | ");
     } 
     else {
-        printf("%4d ", chunk->lines[offset]);
+        printf("%4d ", line);
     }
   
     uint8_t instruction = chunk->code[offset];
@@ -121,7 +153,7 @@ int disassembleInstruction(Chunk* chunk, int offset) {
         case OP_DEFINE_GLOBAL_VAR:
             return identifierInstruction("OP_DEFINE_GLOBAL_VAR", chunk, offset);
         case OP_GET_GLOBAL:
-            return identifierInstruction("OP_GET_GLOBAL", chunk, offset);
+            return cachedIdentifierInstruction("OP_GET_GLOBAL", chunk, offset);
         case OP_SET_GLOBAL:
             return identifierInstruction("OP_SET_GLOBAL", chunk, offset);
         case OP_GET_UPVALUE:
@@ -129,11 +161,11 @@ int disassembleInstruction(Chunk* chunk, int offset) {
         case OP_SET_UPVALUE:
             return byteInstruction("OP_SET_UPVALUE", chunk, offset);
         case OP_GET_PROPERTY:
-            return identifierInstruction("OP_GET_PROPERTY", chunk, offset);
+            return cachedIdentifierInstruction("OP_GET_PROPERTY", chunk, offset);
         case OP_SET_PROPERTY:
-            return identifierInstruction("OP_SET_PROPERTY", chunk, offset);
+            return cachedIdentifierInstruction("OP_SET_PROPERTY", chunk, offset);
         case OP_GET_PROPERTY_OPTIONAL:
-            return identifierInstruction("OP_GET_PROPERTY_OPTIONAL", chunk, offset);
+            return cachedIdentifierInstruction("OP_GET_PROPERTY_OPTIONAL", chunk, offset);
         case OP_GET_SUBSCRIPT:
             return simpleInstruction("OP_GET_SUBSCRIPT", offset);
         case OP_SET_SUBSCRIPT:
@@ -177,11 +209,11 @@ int disassembleInstruction(Chunk* chunk, int offset) {
         case OP_OPTIONAL_CALL: 
             return byteInstruction("OP_OPTIONAL_CALL", chunk, offset);
         case OP_INVOKE:
-            return invokeInstruction("OP_INVOKE", chunk, offset);
+            return cachedInvokeInstruction("OP_INVOKE", chunk, offset);
         case OP_SUPER_INVOKE:
-            return invokeInstruction("OP_SUPER_INVOKE", chunk, offset);
+            return cachedInvokeInstruction("OP_SUPER_INVOKE", chunk, offset);
         case OP_OPTIONAL_INVOKE:
-            return identifierInstruction("OP_OPTIONAL_INVOKE", chunk, offset);
+            return cachedInvokeInstruction("OP_OPTIONAL_INVOKE", chunk, offset);
         case OP_CLOSURE:
             return closureInstruction("OP_CLOSURE", chunk, offset);
         case OP_CLOSE_UPVALUE:
@@ -220,10 +252,6 @@ int disassembleInstruction(Chunk* chunk, int offset) {
             return byteInstruction("OP_USING_NAMESPACE", chunk, offset);
         case OP_THROW:
             return simpleInstruction("OP_THROW", offset);
-        case OP_TRY:
-            return exceptionHandlerInstruction("OP_TRY", chunk, offset);
-        case OP_CATCH:
-            return simpleInstruction("OP_CATCH", offset);
         case OP_FINALLY:
             return simpleInstruction("OP_FINALLY", offset);
         case OP_RETURN:
@@ -236,6 +264,44 @@ int disassembleInstruction(Chunk* chunk, int offset) {
             return simpleInstruction("OP_YIELD_FROM", offset);
         case OP_AWAIT:
             return simpleInstruction("OP_AWAIT", offset);
+        case OP_ADD_INT:
+            return simpleInstruction("OP_ADD_INT", offset);
+        case OP_ADD_FLOAT:
+            return simpleInstruction("OP_ADD_FLOAT", offset);
+        case OP_ADD_STRING:
+            return simpleInstruction("OP_ADD_STRING", offset);
+        case OP_SUBTRACT_INT:
+            return simpleInstruction("OP_SUBTRACT_INT", offset);
+        case OP_SUBTRACT_FLOAT:
+            return simpleInstruction("OP_SUBTRACT_FLOAT", offset);
+        case OP_GREATER_INT:
+            return simpleInstruction("OP_GREATER_INT", offset);
+        case OP_GREATER_FLOAT:
+            return simpleInstruction("OP_GREATER_FLOAT", offset);
+        case OP_LESS_INT:
+            return simpleInstruction("OP_LESS_INT", offset);
+        case OP_LESS_FLOAT:
+            return simpleInstruction("OP_LESS_FLOAT", offset);
+        case OP_EQUAL_INT:
+            return simpleInstruction("OP_EQUAL_INT", offset);
+        case OP_GET_SUBSCRIPT_ARRAY_INT:
+            return simpleInstruction("OP_GET_SUBSCRIPT_ARRAY_INT", offset);
+        case OP_GET_LOCAL_LOCAL:
+            return doubleByteInstruction("OP_GET_LOCAL_LOCAL", chunk, offset);
+        case OP_GET_LOCAL_PROPERTY:
+            return localPropertyInstruction("OP_GET_LOCAL_PROPERTY", chunk, offset);
+        case OP_POP_JUMP_IF_FALSE:
+            return jumpInstruction("OP_POP_JUMP_IF_FALSE", 1, chunk, offset);
+        case OP_FOR_PREP:
+            return jumpInstruction("OP_FOR_PREP", 1, chunk, offset);
+        case OP_FOR_ITER:
+            return forIterInstruction("OP_FOR_ITER", chunk, offset);
+        case OP_TO_STRING:
+            return cachedInvokeInstruction("OP_TO_STRING", chunk, offset);
+        case OP_INTERPOLATE:
+            return byteInstruction("OP_INTERPOLATE", chunk, offset);
+        case OP_TAIL_CALL:
+            return byteInstruction("OP_TAIL_CALL", chunk, offset);
         default:
             printf("Unknown opcode %d\n", instruction);
             return offset + 1;
@@ -68,6 +68,8 @@ bool dictSet(VM* vm, ObjDictionary* dict, Value key, Value value) {
     bool isNewKey = IS_UNDEFINED(entry->key);
     if (isNewKey && IS_NIL(entry->value)) dict->count++;
 
+    PROCESS_WRITE_BARRIER((Obj*)dict, key);
+    PROCESS_WRITE_BARRIER((Obj*)dict, value);
     entry->key = key;
     entry->value = value;
     return isNewKey;
@@ -3,28 +3,61 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "class.h"
 #include "exception.h"
+#include "memory.h"
 #include "native.h"
+#include "variable.h"
 #include "vm.h"
 
+static bool loadExceptionClass(VM* vm, CallFrame* frame, ExceptionHandler* handler, ObjClass** klass) {
+    Chunk* chunk = &frame->closure->function->chunk;
+    ObjModule* module = vm->currentModule;
+    vm->currentModule = frame->closure->module;
+    Value value;
+    bool loaded = loadGlobal(vm, chunk, handler->exceptionType, NULL, &value);
+    vm->currentModule = module;
+
+    if (!loaded) {
+        ObjString* exceptionClass = AS_STRING(chunk->identifiers.values[handler->exceptionType]);
+        runtimeError(vm, "Undefined class %s specified as exception type.", exceptionClass->chars);
+        return false;
+    }
+
+    if (!IS_CLASS(value) || !isClassExtendingSuperclass(AS_CLASS(value), vm->exceptionClass)) {
+        ObjString* exceptionClass = AS_STRING(chunk->identifiers.values[handler->exceptionType]);
+        runtimeError(vm, "Expect subclass of clox.std.lang.Exception, but got Class %s.", exceptionClass->chars);
+        return false;
+    }
+
+    *klass = AS_CLASS(value);
+    return true;
+}
+
 bool propagateException(VM* vm, bool isPromise) {
     ObjException* exception = AS_EXCEPTION(peek(vm, 0));
     while (vm->frameCount > 0) {
         CallFrame* frame = &vm->frames[vm->frameCount - 1];
+        Chunk* chunk = &frame->closure->function->chunk;
+        int offset = (int)(frame->ip - chunk->code - 1);
         Value value = peek(vm, 0);
 
-        for (int i = frame->handlerCount; i > 0; i--) {
-            ExceptionHandler handler = frame->handlerStack[i - 1];
-            if (isObjInstanceOf(vm, OBJ_VAL(exception), handler.exceptionClass)) {
-                frame->ip = &frame->closure->function->chunk.code[handler.handlerAddress];
+        for (int i = chunk->handlerCount; i > 0; i--) {
+            ExceptionHandler* handler = &chunk->handlers[i - 1];
+            if (offset < handler->startAddress || offset >= handler->endAddress) continue;
+
+            ObjClass* exceptionClass;
+            if (!loadExceptionClass(vm, frame, handler, &exceptionClass)) return false;
+            if (isObjInstanceOf(vm, OBJ_VAL(exception), exceptionClass)) {
+                frame->ip = &chunk->code[handler->handlerAddress];
                 if (isPromise && frame->closure->function->isAsync) {
                     run(vm);
                 }
                 return true;
             }
-            else if (handler.finallyAddress != UINT16_MAX) {
+            else if (handler->finallyAddress != UINT16_MAX) {
                 push(vm, TRUE_VAL);
-                frame->ip = &frame->closure->function->chunk.code[handler.finallyAddress];
+                frame->ip = &chunk->code[handler->finallyAddress];
                 if (isPromise && frame->closure->function->isAsync) {
                     pop(vm);
                     Value exceptionValue = pop(vm);
@@ -35,9 +68,7 @@ bool propagateException(VM* vm, bool isPromise) {
             }
         }
 
-        for (int i = 0; i <= frame->closure->function->arity + 1; i++) {
-            pop(vm);
-        }
+        vm->stackTop = frame->slots;
         push(vm, value);
 
         if (frame->closure->function->isGenerator || frame->closure->function->isAsync) {
@@ -50,7 +81,7 @@ bool propagateException(VM* vm, bool isPromise) {
     }
 
     fprintf(stderr, "Unhandled %s.%s: %s\n", exception->obj.klass->namespace->fullName->chars, exception->obj.klass->name->chars, exception->message->chars);
-    ObjArray* stackTrace = exception->stacktrace;
+    ObjArray* stackTrace = getStackTrace(vm, exception);
     for (int i = 0; i < stackTrace->elements.count; i++) {
         Value item = stackTrace->elements.values[i];
         fprintf(stderr, "    %s.\n", AS_CSTRING(item));
@@ -59,35 +90,51 @@ bool propagateException(VM* vm, bool isPromise) {
     return false;
 }
 
-void pushExceptionHandler(VM* vm, ObjClass* exceptionClass, uint16_t handlerAddress, uint16_t finallyAddress) {
-    CallFrame* frame = &vm->frames[vm->frameCount - 1];
-    if (frame->handlerCount >= UINT4_MAX) {
-        runtimeError(vm, "Too many nested exception handlers.");
-        exit(70);
-    }
+void captureStackTrace(VM* vm, ObjException* exception) {
+    push(vm, OBJ_VAL(exception));
+    FREE_ARRAY(TraceFrame, exception->traceFrames, exception->traceCount, exception->obj.generation);
+    exception->traceFrames = NULL;
+    exception->traceCount = 0;
+    exception->stacktrace = NULL;
 
-    frame->handlerStack[frame->handlerCount].handlerAddress = handlerAddress;
-    frame->handlerStack[frame->handlerCount].exceptionClass = exceptionClass;
-    frame->handlerStack[frame->handlerCount].finallyAddress = finallyAddress;
-    frame->handlerCount++;
+    TraceFrame* traceFrames = ALLOCATE(TraceFrame, vm->frameCount, exception->obj.generation);
+    for (int i = vm->frameCount - 1; i >= 0; i--) {
+        CallFrame* frame = &vm->frames[i];
+        TraceFrame* traceFrame = &traceFrames[vm->frameCount - 1 - i];
+        traceFrame->closure = frame->closure;
+        traceFrame->instruction = (int)(frame->ip - frame->closure->function->chunk.code - 1);
+        PROCESS_WRITE_BARRIER((Obj*)exception, OBJ_VAL(frame->closure));
+    }
+    exception->traceFrames = traceFrames;
+    exception->traceCount = vm->frameCount;
+    pop(vm);
 }
 
-ObjArray* getStackTrace(VM* vm) {
+ObjArray* getStackTrace(VM* vm, ObjException* exception) {
+    if (exception->stacktrace != NULL) return exception->stacktrace;
+    push(vm, OBJ_VAL(exception));
     ObjArray* stackTrace = newArray(vm);
     push(vm, OBJ_VAL(stackTrace));
-    for (int i = vm->frameCount - 1; i >= 0; i--) {
+
+    for (int i = 0; i < exception->traceCount; i++) {
         char stackTraceBuffer[UINT8_MAX];
-        CallFrame* frame = &vm->frames[i];
-        ObjModule* module = frame->closure->module;
-        ObjFunction* function = frame->closure->function;
-        size_t instruction = frame->ip - function->chunk.code - 1;
-        uint32_t line = function->chunk.lines[instruction];
+        TraceFrame* traceFrame = &exception->traceFrames[i];
+        ObjModule* module = traceFrame->closure->module;
+        ObjFunction* function = traceFrame->closure->function;
+        int line = getLine(&function->chunk, traceFrame->instruction);
 
         uint8_t length = snprintf(stackTraceBuffer, UINT8_MAX, "in %s() from %s at line %d",
             function->name == NULL ? "script" : function->name->chars, module->path->chars, line);
         ObjString* stackElement = copyString(vm, stackTraceBuffer, length);
         valueArrayWrite(vm, &stackTrace->elements, OBJ_VAL(stackElement));
     }
+
+    exception->stacktrace = stackTrace;
+    PROCESS_WRITE_BARRIER((Obj*)exception, OBJ_VAL(stackTrace));
+    FREE_ARRAY(TraceFrame, exception->traceFrames, exception->traceCount, exception->obj.generation);
+    exception->traceFrames = NULL;
+    exception->traceCount = 0;
+    pop(vm);
     pop(vm);
     return stackTrace;
 }
@@ -99,10 +146,8 @@ ObjException* createException(VM* vm, ObjClass* exceptionClass, const char* form
     int length = vsnprintf(chars, UINT8_MAX, format, args);
     va_end(args);
     ObjString* message = copyString(vm, chars, length);
-    ObjArray* stacktrace = getStackTrace(vm);
-
     ObjException* exception = newException(vm, message, exceptionClass);
-    exception->stacktrace = stacktrace;
+    captureStackTrace(vm, exception);
     return exception;
 }
 
@@ -113,11 +158,9 @@ ObjException* createNativeException(VM* vm, const char* exceptionClassName, cons
     int length = vsnprintf(chars, UINT8_MAX, format, args);
     va_end(args);
     ObjString* message = copyString(vm, chars, length);
-    ObjArray* stacktrace = getStackTrace(vm);
-
     ObjClass* exceptionClass = getNativeClass(vm, exceptionClassName);
     ObjException* exception = newException(vm, message, exceptionClass);
-    exception->stacktrace = stacktrace;
+    captureStackTrace(vm, exception);
     return exception;
 }
 
@@ -128,10 +171,8 @@ ObjException* throwException(VM* vm, ObjClass* exceptionClass, const char* forma
     int length = vsnprintf(chars, UINT8_MAX, format, args);
     va_end(args);
     ObjString* message = copyString(vm, chars, length);
-    ObjArray* stacktrace = getStackTrace(vm);
-
     ObjException* exception = newException(vm, message, exceptionClass);
-    exception->stacktrace = stacktrace;
+    captureStackTrace(vm, exception);
     push(vm, OBJ_VAL(exception));
     if (!propagateException(vm, false)) exit(70);
     else return exception;
@@ -145,10 +186,8 @@ ObjException* throwNativeException(VM* vm, const char* exceptionClassName, const
     int length = vsnprintf(chars, UINT8_MAX, format, args);
     va_end(args);
     ObjString* message = copyString(vm, chars, length);
-    ObjArray* stacktrace = getStackTrace(vm);
-
     ObjException* exception = newException(vm, message, exceptionClass);
-    exception->stacktrace = stacktrace;
+    captureStackTrace(vm, exception);
     push(vm, OBJ_VAL(exception));
     if (!propagateException(vm, false)) exit(70);
     else return exception;
@@ -156,7 +195,7 @@ ObjException* throwNativeException(VM* vm, const char* exceptionClassName, const
 
 ObjException* throwPromiseException(VM* vm, ObjPromise* promise) {
     ObjException* exception = promise->exception;
-    exception->stacktrace = getStackTrace(vm);
+    captureStackTrace(vm, exception);
     CallFrame* frame = &vm->frames[vm->frameCount - 1];
 
     if (frame->closure->function->isAsync) push(vm, OBJ_VAL(vm->runningGenerator));
@@ -4,15 +4,9 @@
 
 #include "value.h"
 
-typedef struct {
-    uint16_t handlerAddress;
-    uint16_t finallyAddress;
-    ObjClass* exceptionClass;
-} ExceptionHandler;
-
 bool propagateException(VM* vm, bool isPromise);
-void pushExceptionHandler(VM* vm, ObjClass* exceptionClass, uint16_t handlerAddress, uint16_t finallyAddress);
-ObjArray* getStackTrace(VM* vm);
+void captureStackTrace(VM* vm, ObjException* exception);
+ObjArray* getStackTrace(VM* vm, ObjException* exception);
 ObjException* createException(VM* vm, ObjClass* exceptionClass, const char* format, ...);
 ObjException* createNativeException(VM* vm, const char* exceptionClassName, const char* format, ...);
 ObjException* throwException(VM* vm, ObjClass* exceptionClass, const char* format, ...);
@@ -76,3 +76,101 @@ uint32_t hashValue(Value value) {
     if (IS_OBJ(value)) return hashObject(AS_OBJ(value));
     return hash64To32Bits(value);
 }
+
+static const uint32_t sha256Constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTATE_RIGHT(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void transformSha256(Sha256* sha256, const uint8_t* block) {
+    uint32_t words[64];
+    for (int i = 0; i < 16; i++) {
+        words[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) | ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    }
+
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTATE_RIGHT(words[i - 15], 7) ^ ROTATE_RIGHT(words[i - 15], 18) ^ (words[i - 15] >> 3);
+        uint32_t s1 = ROTATE_RIGHT(words[i - 2], 17) ^ ROTATE_RIGHT(words[i - 2], 19) ^ (words[i - 2] >> 10);
+        words[i] = words[i - 16] + s0 + words[i - 7] + s1;
+    }
+
+    uint32_t a = sha256->state[0], b = sha256->state[1], c = sha256->state[2], d = sha256->state[3];
+    uint32_t e = sha256->state[4], f = sha256->state[5], g = sha256->state[6], h = sha256->state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t s1 = ROTATE_RIGHT(e, 6) ^ ROTATE_RIGHT(e, 11) ^ ROTATE_RIGHT(e, 25);
+        uint32_t choice = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + s1 + choice + sha256Constants[i] + words[i];
+        uint32_t s0 = ROTATE_RIGHT(a, 2) ^ ROTATE_RIGHT(a, 13) ^ ROTATE_RIGHT(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    sha256->state[0] += a;
+    sha256->state[1] += b;
+    sha256->state[2] += c;
+    sha256->state[3] += d;
+    sha256->state[4] += e;
+    sha256->state[5] += f;
+    sha256->state[6] += g;
+    sha256->state[7] += h;
+}
+
+#undef ROTATE_RIGHT
+
+void initSha256(Sha256* sha256) {
+    static const uint32_t initialState[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(sha256->state, initialState, sizeof(initialState));
+    sha256->length = 0;
+    sha256->bufferLength = 0;
+}
+
+void updateSha256(Sha256* sha256, const void* bytes, size_t length) {
+    const uint8_t* data = (const uint8_t*)bytes;
+    sha256->length += length;
+    for (size_t i = 0; i < length; i++) {
+        sha256->buffer[sha256->bufferLength++] = data[i];
+        if (sha256->bufferLength == 64) {
+            transformSha256(sha256, sha256->buffer);
+            sha256->bufferLength = 0;
+        }
+    }
+}
+
+void finalSha256(Sha256* sha256, uint8_t digest[SHA256_DIGEST_SIZE]) {
+    uint64_t bitLength = sha256->length * 8;
+    uint8_t padding = 0x80;
+    updateSha256(sha256, &padding, 1);
+
+    padding = 0;
+    while (sha256->bufferLength != 56) updateSha256(sha256, &padding, 1);
+    for (int i = 7; i >= 0; i--) {
+        uint8_t byte = (uint8_t)(bitLength >> (i * 8));
+        updateSha256(sha256, &byte, 1);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(sha256->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(sha256->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(sha256->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)sha256->state[i];
+    }
+}
@@ -5,9 +5,21 @@
 #include "object.h"
 #include "value.h"
 
+#define SHA256_DIGEST_SIZE 32
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t buffer[64];
+    size_t bufferLength;
+} Sha256;
+
 uint32_t hashString(const char* chars, int length);
 uint32_t hashObject(Obj* object);
 uint32_t hashValue(Value value);
+void initSha256(Sha256* sha256);
+void updateSha256(Sha256* sha256, const void* bytes, size_t length);
+void finalSha256(Sha256* sha256, uint8_t digest[SHA256_DIGEST_SIZE]);
 
 static inline uint32_t hash64To32Bits(uint64_t hash) {
     hash = ~hash + (hash << 18);
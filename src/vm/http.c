@@ -9,6 +9,15 @@
 #include "vm.h"
 #include "../common/os.h"
 
+static bool curlInitialized = false;
+
+static void httpCURLGlobalInit() {
+    if (!curlInitialized) {
+        curl_global_init(CURL_GLOBAL_ALL);
+        curlInitialized = true;
+    }
+}
+
 static CURLMsg* httpCURLInfoRead(CURLContext* context, CURLData* data, int* messagesInQueue) {
     CURLMsg* message = curl_multi_info_read(context->data->curlM, messagesInQueue);
     if (data != NULL) {
@@ -191,6 +200,11 @@ size_t httpCURLHeaders(void* headers, size_t size, size_t nitems, void* userData
     return realsize;
 }
 
+CURL* httpCURLInit() {
+    httpCURLGlobalInit();
+    return curl_easy_init();
+}
+
 void httpCURLInitContext(CURLContext* context, curl_socket_t socket) {
     context->socket = socket;
     uv_poll_init_socket(context->data->vm->eventLoop, &context->poll, socket);
@@ -208,6 +222,11 @@ CURLMData* httpCURLMData(VM* vm, CURLM* curlM, uv_timer_t* timer) {
     return curlMData;
 }
 
+CURLM* httpCURLMInit() {
+    httpCURLGlobalInit();
+    return curl_multi_init();
+}
+
 
 int httpCURLPollSocket(CURL* curl, curl_socket_t socket, int action, void* userData, void* socketData) {
     CURLContext* context = NULL;
@@ -283,7 +302,7 @@ ObjPromise* httpDownloadFileAsync(VM* vm, ObjString* src, ObjString* dest, CURLM
     FILE* file;
     fopen_s(&file, dest->chars, "w");
     if (file != NULL) {
-        CURL* curl = curl_easy_init();
+        CURL* curl = httpCURLInit();
         const char* url = src->chars;
         ObjPromise* promise = newPromise(vm, PROMISE_PENDING, NIL_VAL, NIL_VAL);
         CURLData* curlData = httpCURLData(vm, curl, src, HTTP_GET, promise, NULL, callback);
@@ -399,7 +418,7 @@ CURLcode httpSendRequest(VM* vm, ObjString* url, HTTPMethod method, ObjDictionar
 ObjPromise* httpSendRequestAsync(VM* vm, ObjString* url, HTTPMethod method, ObjDictionary* headers, ObjDictionary* data, CURLMData* curlMData, curl_multi_cb callback) {
     CURLResponse* curlResponse = ALLOCATE_STRUCT(CURLResponse);
     if (curlResponse != NULL) {
-        CURL* curl = curl_easy_init();
+        CURL* curl = httpCURLInit();
         ObjPromise* promise = newPromise(vm, PROMISE_PENDING, NIL_VAL, NIL_VAL);
         CURLData* curlData = httpCURLData(vm, curl, url, method, promise, curlResponse, callback);
         httpCURLInitResponse(curlResponse);
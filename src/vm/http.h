@@ -60,8 +60,10 @@ ObjInstance* httpCreateResponse(VM* vm, ObjString* url, CURL* curl, CURLResponse
 CURLContext* httpCURLCreateContext(CURLMData* data);
 CURLData* httpCURLData(VM* vm, CURL* curl, ObjString* url, HTTPMethod method, ObjPromise* promise, CURLResponse* curlResponse, curl_multi_cb callback);
 size_t httpCURLHeaders(void* headers, size_t size, size_t nitems, void* userData);
+CURL* httpCURLInit();
 void httpCURLInitContext(CURLContext* context, curl_socket_t socket);
 CURLMData* httpCURLMData(VM* vm, CURLM* curlM, uv_timer_t* timer);
+CURLM* httpCURLMInit();
 int httpCURLPollSocket(CURL* curl, curl_socket_t socket, int action, void* userData, void* socketData);
 size_t httpCURLResponse(void* contents, size_t size, size_t nmemb, void* userData);
 void httpCURLStartTimeout(CURLM* curlM, long timeout, void* userData);
@@ -12,21 +12,30 @@ static bool isInterceptorMethod(ObjString* name) {
         name->chars[name->length - 1] == '_' && name->chars[name->length - 2] == '_');
 }
 
+static const char* interceptorNames[INTERCEPTOR_COUNT] = {
+    "__init__", "__beforeGet__", "__afterGet__", "__beforeSet__", "__afterSet__", "__onInvoke__",
+    "__onReturn__", "__onThrow__", "__onYield__", "__onAwait__", "__undefinedGet__", "__undefinedInvoke__"
+};
+
+void initInterceptorStrings(VM* vm) {
+    for (int i = 0; i < INTERCEPTOR_COUNT; i++) {
+        vm->interceptorStrings[i] = newStringPerma(vm, interceptorNames[i]);
+    }
+}
+
+InterceptorType getInterceptorType(VM* vm, ObjString* name) {
+    if (!isInterceptorMethod(name)) return INTERCEPTOR_NONE;
+    for (int i = 0; i < INTERCEPTOR_COUNT; i++) {
+        if (name == vm->interceptorStrings[i]) return (InterceptorType)i;
+    }
+    return INTERCEPTOR_NONE;
+}
+
 void handleInterceptorMethod(VM* vm, ObjClass* klass, ObjString* name) {
     if (!isInterceptorMethod(name)) return;
 
-    else if (strcmp(name->chars, "__init__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_INIT);
-    else if (strcmp(name->chars, "__beforeGet__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_BEFORE_GET);
-    else if (strcmp(name->chars, "__afterGet__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_AFTER_GET);
-    else if (strcmp(name->chars, "__beforeSet__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_BEFORE_SET);
-    else if (strcmp(name->chars, "__afterSet__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_AFTER_SET);
-    else if (strcmp(name->chars, "__onInvoke__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_ON_INVOKE);
-    else if (strcmp(name->chars, "__onReturn__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_ON_RETURN);
-    else if (strcmp(name->chars, "__onThrow__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_ON_THROW);
-    else if (strcmp(name->chars, "__onYield__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_ON_YIELD);
-    else if (strcmp(name->chars, "__onAwait__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_ON_AWAIT);
-    else if (strcmp(name->chars, "__undefinedGet__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_UNDEFINED_GET);
-    else if (strcmp(name->chars, "__undefinedInvoke__") == 0) SET_CLASS_INTERCEPTOR(klass, INTERCEPTOR_UNDEFINED_INVOKE);
+    InterceptorType type = getInterceptorType(vm, name);
+    if (type != INTERCEPTOR_NONE) SET_CLASS_INTERCEPTOR(klass, type);
     else {
         runtimeError(vm, "Invalid interceptor method specified.");
         exit(70);
@@ -43,7 +52,7 @@ bool hasInterceptableMethod(VM* vm, Value receiver, ObjString* name) {
 bool interceptBeforeGet(VM* vm, Value receiver, ObjString* name) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__beforeGet__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_BEFORE_GET], &interceptor)) {
         callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name));
         return true;
     }
@@ -53,7 +62,7 @@ bool interceptBeforeGet(VM* vm, Value receiver, ObjString* name) {
 bool interceptAfterGet(VM* vm, Value receiver, ObjString* name, Value value) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__afterGet__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_AFTER_GET], &interceptor)) {
         Value result = callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), value);
         push(vm, result);
         return true;
@@ -64,7 +73,7 @@ bool interceptAfterGet(VM* vm, Value receiver, ObjString* name, Value value) {
 bool interceptBeforeSet(VM* vm, Value receiver, ObjString* name, Value value) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__beforeSet__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_BEFORE_SET], &interceptor)) {
         Value result = callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), value);
         push(vm, result);
         return true;
@@ -75,7 +84,7 @@ bool interceptBeforeSet(VM* vm, Value receiver, ObjString* name, Value value) {
 bool interceptAfterSet(VM* vm, Value receiver, ObjString* name) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__afterSet__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_AFTER_SET], &interceptor)) {
         callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name));
         return true;
     }
@@ -102,7 +111,7 @@ static void unloadInterceptorArguments(VM* vm, ObjArray* args) {
 bool interceptOnInvoke(VM* vm, Value receiver, ObjString* name, int argCount) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__onInvoke__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_ON_INVOKE], &interceptor)) {
         ObjArray* args = loadInterceptorArguments(vm, argCount);
         callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), OBJ_VAL(args));
         unloadInterceptorArguments(vm, args);
@@ -114,9 +123,9 @@ bool interceptOnInvoke(VM* vm, Value receiver, ObjString* name, int argCount) {
 bool interceptOnReturn(VM* vm, Value receiver, ObjString* name, Value result) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__onReturn__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_ON_RETURN], &interceptor)) {
         Value result2 = callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), result);
-        push(vm, result2);
+        vm->stackTop[-1] = result2;
         return true;
     }
     return false;
@@ -125,7 +134,7 @@ bool interceptOnReturn(VM* vm, Value receiver, ObjString* name, Value result) {
 bool interceptOnThrow(VM* vm, Value receiver, ObjString* name, Value exception) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__onThrow__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_ON_THROW], &interceptor)) {
         Value exception2 = callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), exception);
         push(vm, exception2);
         return true;
@@ -136,7 +145,7 @@ bool interceptOnThrow(VM* vm, Value receiver, ObjString* name, Value exception)
 bool interceptOnYield(VM* vm, Value receiver, ObjString* name, Value result) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__onYield__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_ON_YIELD], &interceptor)) {
         Value result2 = callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), result);
         pop(vm);
         push(vm, result2);
@@ -148,7 +157,7 @@ bool interceptOnYield(VM* vm, Value receiver, ObjString* name, Value result) {
 bool interceptOnAwait(VM* vm, Value receiver, ObjString* name, Value result) {
     ObjClass* klass = getObjClass(vm, receiver);
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__onAwait__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_ON_AWAIT], &interceptor)) {
         Value result2 = callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name), result);
         pop(vm);
         if (!IS_PROMISE(result2)) result2 = OBJ_VAL(promiseWithFulfilled(vm, result));
@@ -160,8 +169,9 @@ bool interceptOnAwait(VM* vm, Value receiver, ObjString* name, Value result) {
 
 bool interceptUndefinedGet(VM* vm, Value receiver, ObjString* name) {
     ObjClass* klass = getObjClass(vm, receiver);
+    if (!HAS_CLASS_INTERCEPTOR(klass, INTERCEPTOR_UNDEFINED_GET)) return false;
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__undefinedGet__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_UNDEFINED_GET], &interceptor)) {
         callReentrantMethod(vm, receiver, interceptor, OBJ_VAL(name));
         return true;
     }
@@ -169,8 +179,9 @@ bool interceptUndefinedGet(VM* vm, Value receiver, ObjString* name) {
 }
 
 bool interceptUndefinedInvoke(VM* vm, ObjClass* klass, ObjString* name, int argCount) {
+    if (!HAS_CLASS_INTERCEPTOR(klass, INTERCEPTOR_UNDEFINED_INVOKE)) return false;
     Value interceptor;
-    if (tableGet(&klass->methods, newStringPerma(vm, "__undefinedInvoke__"), &interceptor)) {
+    if (tableGet(&klass->methods, vm->interceptorStrings[INTERCEPTOR_UNDEFINED_INVOKE], &interceptor)) {
         ObjArray* args = loadInterceptorArguments(vm, argCount);
         push(vm, OBJ_VAL(name));
         push(vm, OBJ_VAL(args));
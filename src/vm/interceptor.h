@@ -9,6 +9,7 @@
 #define HAS_OBJ_INTERCEPTOR(object, interceptor) (IS_OBJ(object) && HAS_CLASS_INTERCEPTOR(AS_OBJ(object)->klass, interceptor))
 
 typedef enum {
+    INTERCEPTOR_NONE = -1,
     INTERCEPTOR_INIT,
     INTERCEPTOR_BEFORE_GET,
     INTERCEPTOR_AFTER_GET,
@@ -20,9 +21,13 @@ typedef enum {
     INTERCEPTOR_ON_YIELD,
     INTERCEPTOR_ON_AWAIT,
     INTERCEPTOR_UNDEFINED_GET,
-    INTERCEPTOR_UNDEFINED_INVOKE
+    INTERCEPTOR_UNDEFINED_INVOKE,
+    INTERCEPTOR_COUNT
 } InterceptorType;
 
+void initInterceptorStrings(VM* vm);
+InterceptorType getInterceptorType(VM* vm, ObjString* name);
+
 void handleInterceptorMethod(VM* vm, ObjClass* klass, ObjString* name);
 bool hasInterceptableMethod(VM* vm, Value receiver, ObjString* name);
 bool interceptBeforeGet(VM* vm, Value receiver, ObjString* name);
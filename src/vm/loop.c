@@ -11,10 +11,17 @@ void initLoop(VM* vm) {
     vm->eventLoop = ALLOCATE_STRUCT(uv_loop_t);
     ABORT_IFNULL(vm->eventLoop, "Not enough memory to create event loop.");
     uv_loop_init(vm->eventLoop);
+
+    vm->gc->markIdle = ALLOCATE_STRUCT(uv_idle_t);
+    ABORT_IFNULL(vm->gc->markIdle, "Not enough memory to create idle handle for garbage collector.");
+    uv_idle_init(vm->eventLoop, vm->gc->markIdle);
+    uv_unref((uv_handle_t*)vm->gc->markIdle);
+    vm->gc->markIdle->data = vm;
 }
 
 void freeLoop(VM* vm) {
     if (vm->eventLoop != NULL) {
+        uv_run(vm->eventLoop, UV_RUN_NOWAIT);
         uv_loop_close(vm->eventLoop);
         free(vm->eventLoop);
     }
@@ -1,7 +1,9 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "hash.h"
 #include "memory.h"
+#include "../common/os.h"
 
 #ifdef DEBUG_LOG_GC
 #include <stdio.h>
@@ -10,19 +12,80 @@
 
 #pragma warning(disable : 33010)
 
-void* reallocate(VM* vm, void* pointer, size_t oldSize, size_t newSize, GCGenerationType generation) {
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GC_THREAD_LOCAL __declspec(thread)
+#define GC_ATOMIC_LOAD(value) (*(volatile int*)&(value))
+#define GC_ATOMIC_STORE(target, value) (*(volatile int*)&(target) = (value))
+#define GC_IS_MARKED(object) (*(volatile bool*)&(object)->isMarked)
+#define GC_TRY_MARK(object) (_InterlockedExchange8((volatile char*)&(object)->isMarked, 1) == 0)
+#else
+#define GC_THREAD_LOCAL _Thread_local
+#define GC_ATOMIC_LOAD(value) __atomic_load_n(&(value), __ATOMIC_ACQUIRE)
+#define GC_ATOMIC_STORE(target, value) __atomic_store_n(&(target), (value), __ATOMIC_RELEASE)
+#define GC_IS_MARKED(object) __atomic_load_n(&(object)->isMarked, __ATOMIC_ACQUIRE)
+#define GC_TRY_MARK(object) (!__atomic_exchange_n(&(object)->isMarked, true, __ATOMIC_ACQ_REL))
+#endif
+
+static GC_THREAD_LOCAL GCWorker* currentWorker = NULL;
+
+static void startIncrementalMarking(VM* vm);
+static bool markIncrementally(VM* vm);
+static GCWorkerPool* newGCWorkerPool(VM* vm, int workerCount);
+static void freeGCWorkerPool(GCWorkerPool* pool);
+static void runGCJob(VM* vm, GCJobType job, GCGenerationType generation);
+
+static bool isHeapExhausted(GCGeneration* heap) {
+    return heap->bytesAllocated > heap->heapSize;
+}
+
+static void triggerGarbageCollection(VM* vm, GCGenerationType generation) {
+    while (generation < GC_GENERATION_TYPE_OLD && isHeapExhausted(GET_GC_GENERATION(generation + 1))) {
+        generation++;
+    }
+
+    if (generation < GC_GENERATION_TYPE_OLD || vm->config.gcMaxPause <= 0) {
+        collectGarbage(vm, generation);
+    }
+    else if (vm->gc->isMarking && GET_GC_GENERATION(generation)->bytesAllocated > GET_GC_GENERATION(generation)->heapSize * 2) {
+        collectGarbage(vm, generation);
+    }
+    else {
+        collectGarbage(vm, GC_GENERATION_TYPE_YOUNG);
+        if (!vm->gc->isMarking) startIncrementalMarking(vm);
+    }
+}
+
+static void accountAllocation(VM* vm, size_t oldSize, size_t newSize, GCGenerationType generation) {
+    if (currentWorker != NULL) {
+        currentWorker->freedBytes[generation] += oldSize - newSize;
+        return;
+    }
+
     GCGeneration* currentHeap = GET_GC_GENERATION(generation);
-    currentHeap->bytesAllocated += newSize - oldSize;
+    if (newSize < oldSize && currentHeap->bytesAllocated < oldSize - newSize) currentHeap->bytesAllocated = 0;
+    else currentHeap->bytesAllocated += newSize - oldSize;
     if (newSize > oldSize && generation < GC_GENERATION_TYPE_PERMANENT) {
 #ifdef DEBUG_STRESS_GC
         collectGarbage(vm, generation);
 #endif
 
-        if (currentHeap->bytesAllocated > currentHeap->heapSize) {
-            collectGarbage(vm, generation);
+        if (vm->gc->isMarking) {
+            vm->gc->markDebt += newSize - oldSize;
+            if (vm->gc->markDebt >= GC_MARK_STEP_SIZE) {
+                vm->gc->markDebt = 0;
+                if (markIncrementally(vm)) collectGarbage(vm, GC_GENERATION_TYPE_OLD);
+            }
+        }
+
+        if (isHeapExhausted(currentHeap)) {
+            triggerGarbageCollection(vm, generation);
         }
     }
+}
 
+void* reallocate(VM* vm, void* pointer, size_t oldSize, size_t newSize, GCGenerationType generation) {
+    accountAllocation(vm, oldSize, newSize, generation);
     if (newSize == 0) {
         free(pointer);
         return NULL;
@@ -33,16 +96,266 @@ void* reallocate(VM* vm, void* pointer, size_t oldSize, size_t newSize, GCGenera
     return result;
 }
 
-static void initGCRememberedSet(GCRememberedSet* rememberedSet, GCGenerationType generation) {
-    rememberedSet->capacity = 0;
-    rememberedSet->count = 0;
-    rememberedSet->generation = generation;
-    rememberedSet->entries = NULL;
+static GCEdenBlock* getEdenBlock(Obj* object) {
+    return (GCEdenBlock*)((uintptr_t)object & ~((uintptr_t)GC_EDEN_BLOCK_SIZE - 1));
+}
+
+static size_t edenAlignedSize(size_t size) {
+    return (size + GC_EDEN_GRANULE_SIZE - 1) & ~((size_t)GC_EDEN_GRANULE_SIZE - 1);
+}
+
+static size_t edenGranule(GCEdenBlock* block, uint8_t* address) {
+    return (size_t)(address - (uint8_t*)block) / GC_EDEN_GRANULE_SIZE;
+}
+
+static bool isEdenGranuleAllocated(GCEdenBlock* block, size_t granule) {
+    return (block->granules[granule / 64] >> (granule % 64)) & 1;
+}
+
+static void setEdenGranules(GCEdenBlock* block, size_t first, size_t count, bool isAllocated) {
+    while (count > 0) {
+        size_t bit = first % 64;
+        size_t length = count < 64 - bit ? count : 64 - bit;
+        uint64_t mask = (length == 64 ? UINT64_MAX : ((UINT64_C(1) << length) - 1)) << bit;
+        if (isAllocated) block->granules[first / 64] |= mask;
+        else block->granules[first / 64] &= ~mask;
+        first += length;
+        count -= length;
+    }
 }
 
-static void freeGCRememeberedSet(VM* vm, GCRememberedSet* remSet) {
-    FREE_ARRAY(GCRememberedEntry, remSet->entries, remSet->capacity, remSet->generation);
-    initGCRememberedSet(remSet, remSet->generation);
+static void initEdenBlock(GCEdenBlock* block) {
+    block->next = NULL;
+    block->objectCount = 0;
+    block->liveBytes = 0;
+    block->isAvailable = false;
+    memset(block->granules, 0, sizeof(block->granules));
+    setEdenGranules(block, 0, edenAlignedSize(sizeof(GCEdenBlock)) / GC_EDEN_GRANULE_SIZE, true);
+}
+
+static bool findEdenHole(GC* gc, GCEdenBlock* block, size_t granule, size_t size) {
+    while (granule < GC_EDEN_GRANULE_COUNT) {
+        if (block->granules[granule / 64] == UINT64_MAX) {
+            granule = (granule / 64 + 1) * 64;
+            continue;
+        }
+        if (isEdenGranuleAllocated(block, granule)) {
+            granule++;
+            continue;
+        }
+
+        size_t end = granule + 1;
+        while (end < GC_EDEN_GRANULE_COUNT && !isEdenGranuleAllocated(block, end)) {
+            end += (end % 64 == 0 && block->granules[end / 64] == 0) ? 64 : 1;
+        }
+
+        if ((end - granule) * GC_EDEN_GRANULE_SIZE >= size) {
+            gc->edenBlock = block;
+            gc->edenTop = (uint8_t*)block + granule * GC_EDEN_GRANULE_SIZE;
+            gc->edenEnd = (uint8_t*)block + end * GC_EDEN_GRANULE_SIZE;
+            return true;
+        }
+        granule = end;
+    }
+    return false;
+}
+
+static void nextEdenHole(GC* gc, size_t size) {
+    GCEdenBlock* block = gc->edenBlock;
+    if (block != NULL && findEdenHole(gc, block, edenGranule(block, gc->edenEnd), size)) return;
+
+    while (gc->availableBlocks != NULL) {
+        block = gc->availableBlocks;
+        gc->availableBlocks = block->next;
+        gc->availableBlockCount--;
+        block->isAvailable = false;
+        if (findEdenHole(gc, block, 0, size)) return;
+    }
+
+    block = (GCEdenBlock*)_aligned_malloc(GC_EDEN_BLOCK_SIZE, GC_EDEN_BLOCK_SIZE);
+    if (block == NULL) {
+        fprintf(stderr, "Not enough memory to allocate eden block for garbage collector.");
+        exit(74);
+    }
+    initEdenBlock(block);
+    findEdenHole(gc, block, 0, size);
+}
+
+static void releaseEdenBlock(VM* vm, GCEdenBlock* block) {
+    GC* gc = vm->gc;
+    if (block == gc->edenBlock) {
+        if (block->objectCount == 0) findEdenHole(gc, block, 0, 0);
+    }
+    else if (block->isAvailable) return;
+    else if (block->objectCount == 0 && (size_t)gc->availableBlockCount * GC_EDEN_BLOCK_SIZE >= vm->config.gcEdenHeapSize) {
+        _aligned_free(block);
+    }
+    else if (block->liveBytes <= GC_EDEN_BLOCK_SIZE / 2) {
+        block->next = gc->availableBlocks;
+        block->isAvailable = true;
+        gc->availableBlocks = block;
+        gc->availableBlockCount++;
+    }
+}
+
+void* bumpAllocate(VM* vm, size_t size) {
+    accountAllocation(vm, 0, size, GC_GENERATION_TYPE_EDEN);
+    GC* gc = vm->gc;
+    size_t alignedSize = edenAlignedSize(size);
+    if (gc->edenBlock == NULL || gc->edenTop + alignedSize > gc->edenEnd) nextEdenHole(gc, alignedSize);
+
+    GCEdenBlock* block = gc->edenBlock;
+    void* result = gc->edenTop;
+    gc->edenTop += alignedSize;
+    setEdenGranules(block, edenGranule(block, result), alignedSize / GC_EDEN_GRANULE_SIZE, true);
+    block->objectCount++;
+    block->liveBytes += (int)alignedSize;
+    return result;
+}
+
+static int slabSizeClass(size_t size) {
+    return (int)((size + GC_SLAB_SIZE_CLASS_GRANULARITY - 1) / GC_SLAB_SIZE_CLASS_GRANULARITY) - 1;
+}
+
+static size_t slabSlotSize(int sizeClass) {
+    return (size_t)(sizeClass + 1) * GC_SLAB_SIZE_CLASS_GRANULARITY;
+}
+
+static size_t slabHeaderSize() {
+    return (sizeof(GCSlabPage) + GC_SLAB_SIZE_CLASS_GRANULARITY - 1) & ~((size_t)GC_SLAB_SIZE_CLASS_GRANULARITY - 1);
+}
+
+static void linkSlabPage(GCSlabHeap* slabHeap, GCSlabPage* page) {
+    page->previous = NULL;
+    page->next = slabHeap->pages[page->sizeClass];
+    if (page->next != NULL) page->next->previous = page;
+    slabHeap->pages[page->sizeClass] = page;
+}
+
+static void unlinkSlabPage(GCSlabHeap* slabHeap, GCSlabPage* page) {
+    if (page->previous != NULL) page->previous->next = page->next;
+    else slabHeap->pages[page->sizeClass] = page->next;
+    if (page->next != NULL) page->next->previous = page->previous;
+    page->next = NULL;
+    page->previous = NULL;
+}
+
+static GCSlabPage* newSlabPage(GCSlabHeap* slabHeap, int sizeClass, GCGenerationType generation) {
+    GCSlabPage* page = (GCSlabPage*)_aligned_malloc(GC_SLAB_PAGE_SIZE, GC_SLAB_PAGE_SIZE);
+    if (page == NULL) {
+        fprintf(stderr, "Not enough memory to allocate slab page for garbage collector.");
+        exit(74);
+    }
+
+    page->freeSlots = NULL;
+    page->top = (uint8_t*)page + slabHeaderSize();
+    page->generation = generation;
+    page->sizeClass = sizeClass;
+    page->slotCount = (int)((GC_SLAB_PAGE_SIZE - slabHeaderSize()) / slabSlotSize(sizeClass));
+    page->liveCount = 0;
+    linkSlabPage(slabHeap, page);
+    slabHeap->pageCount++;
+    return page;
+}
+
+void* slabAllocate(VM* vm, size_t size, GCGenerationType generation) {
+    accountAllocation(vm, 0, size, generation);
+    GCSlabHeap* slabHeap = &GET_GC_GENERATION(generation)->slabHeap;
+    int sizeClass = slabSizeClass(size);
+    GCSlabPage* page = slabHeap->pages[sizeClass];
+    if (page == NULL) page = newSlabPage(slabHeap, sizeClass, generation);
+
+    void* result = NULL;
+    if (page->freeSlots != NULL) {
+        result = page->freeSlots;
+        page->freeSlots = page->freeSlots->next;
+    }
+    else {
+        result = page->top;
+        page->top += slabSlotSize(sizeClass);
+    }
+
+    if (++page->liveCount == page->slotCount) unlinkSlabPage(slabHeap, page);
+    slabHeap->slotBytes += slabSlotSize(sizeClass);
+    slabHeap->requestedBytes += size;
+    return result;
+}
+
+static void slabFree(VM* vm, Obj* object, size_t size) {
+    GCSlabPage* page = (GCSlabPage*)((uintptr_t)object & ~((uintptr_t)GC_SLAB_PAGE_SIZE - 1));
+    GCSlabHeap* slabHeap = &GET_GC_GENERATION(page->generation)->slabHeap;
+    GCSlabSlot* slot = (GCSlabSlot*)object;
+    slot->next = page->freeSlots;
+    page->freeSlots = slot;
+    slabHeap->slotBytes -= slabSlotSize(page->sizeClass);
+    slabHeap->requestedBytes -= size;
+
+    if (page->liveCount-- == page->slotCount) linkSlabPage(slabHeap, page);
+    if (page->liveCount == 0 && (page->previous != NULL || page->next != NULL)) {
+        unlinkSlabPage(slabHeap, page);
+        slabHeap->pageCount--;
+        _aligned_free(page);
+    }
+}
+
+static void freeObjectMemory(VM* vm, Obj* object, size_t size) {
+    if (object->isBumpAllocated) {
+        accountAllocation(vm, size, 0, object->generation);
+        GCEdenBlock* block = getEdenBlock(object);
+        size_t alignedSize = edenAlignedSize(size);
+        setEdenGranules(block, edenGranule(block, (uint8_t*)object), alignedSize / GC_EDEN_GRANULE_SIZE, false);
+        block->objectCount--;
+        block->liveBytes -= (int)alignedSize;
+        releaseEdenBlock(vm, block);
+    }
+    else if (object->isSlabAllocated) {
+        accountAllocation(vm, size, 0, object->generation);
+        slabFree(vm, object, size);
+    }
+    else reallocate(vm, object, size, 0, object->generation);
+}
+
+static void initGCRememberedSet(GCRememberedSet* remSet) {
+    remSet->capacity = 0;
+    remSet->count = 0;
+    remSet->objects = NULL;
+}
+
+static void freeGCRememberedSet(GCRememberedSet* remSet) {
+    free(remSet->objects);
+    initGCRememberedSet(remSet);
+}
+
+static void initGCSweepSegments(GCSweepSegments* sweepSegments) {
+    sweepSegments->capacity = 0;
+    sweepSegments->count = 0;
+    sweepSegments->heads = NULL;
+}
+
+static void freeGCSweepSegments(GCSweepSegments* sweepSegments) {
+    free(sweepSegments->heads);
+    initGCSweepSegments(sweepSegments);
+}
+
+static void initGCSlabHeap(GCSlabHeap* slabHeap) {
+    for (int i = 0; i < GC_SLAB_SIZE_CLASS_COUNT; i++) {
+        slabHeap->pages[i] = NULL;
+    }
+    slabHeap->pageCount = 0;
+    slabHeap->slotBytes = 0;
+    slabHeap->requestedBytes = 0;
+}
+
+static void freeGCSlabHeap(GCSlabHeap* slabHeap) {
+    for (int i = 0; i < GC_SLAB_SIZE_CLASS_COUNT; i++) {
+        GCSlabPage* page = slabHeap->pages[i];
+        while (page != NULL) {
+            GCSlabPage* next = page->next;
+            _aligned_free(page);
+            page = next;
+        }
+    }
+    initGCSlabHeap(slabHeap);
 }
 
 static void initGCGenerations(GC* gc, size_t heapSizes[]) {
@@ -52,8 +365,11 @@ static void initGCGenerations(GC* gc, size_t heapSizes[]) {
             gc->generations[i]->bytesAllocated = 0;
             gc->generations[i]->heapSize = heapSizes[i]; 
             gc->generations[i]->objects = NULL;
+            gc->generations[i]->objectCount = 0;
             gc->generations[i]->type = i;
-            initGCRememberedSet(&gc->generations[i]->remSet, i);
+            initGCSweepSegments(&gc->generations[i]->sweepSegments);
+            initGCSlabHeap(&gc->generations[i]->slabHeap);
+            initGCRememberedSet(&gc->generations[i]->remSet);
         }
         else {
             fprintf(stderr, "Not enough memory to allocate heaps for garbage collector.");
@@ -64,7 +380,9 @@ static void initGCGenerations(GC* gc, size_t heapSizes[]) {
 
 static void freeGCGenerations(VM* vm) {
     for (int i = 0; i < GC_GENERATION_TYPE_COUNT; i++) {
-        freeGCRememeberedSet(vm, &vm->gc->generations[i]->remSet);
+        freeGCRememberedSet(&vm->gc->generations[i]->remSet);
+        freeGCSweepSegments(&vm->gc->generations[i]->sweepSegments);
+        freeGCSlabHeap(&vm->gc->generations[i]->slabHeap);
         free(vm->gc->generations[i]);
     }
 }
@@ -74,6 +392,15 @@ GC* newGC(VM* vm) {
     if (gc != NULL) {
         size_t heapSizes[] = { vm->config.gcEdenHeapSize, vm->config.gcYoungHeapSize, vm->config.gcOldHeapSize, vm->config.gcTotalHeapSize - vm->config.gcEdenHeapSize - vm->config.gcYoungHeapSize - vm->config.gcOldHeapSize };
         initGCGenerations(gc, heapSizes);
+        gc->edenBlock = NULL;
+        gc->availableBlocks = NULL;
+        gc->edenTop = NULL;
+        gc->edenEnd = NULL;
+        gc->availableBlockCount = 0;
+        gc->isMarking = false;
+        gc->markDebt = 0;
+        gc->markIdle = NULL;
+        gc->workerPool = vm->config.gcWorkerCount > 0 ? newGCWorkerPool(vm, vm->config.gcWorkerCount) : NULL;
         gc->grayCapacity = 0;
         gc->grayCount = 0;
         gc->grayStack = NULL;
@@ -84,79 +411,88 @@ GC* newGC(VM* vm) {
     exit(74);
 }
 
+static void closeMarkIdle(uv_handle_t* handle) {
+    free(handle);
+}
+
 void freeGC(VM* vm) {
+    if (vm->gc->workerPool != NULL) freeGCWorkerPool(vm->gc->workerPool);
+    if (vm->gc->markIdle != NULL) {
+        uv_idle_stop(vm->gc->markIdle);
+        uv_close((uv_handle_t*)vm->gc->markIdle, closeMarkIdle);
+    }
+    while (vm->gc->availableBlocks != NULL) {
+        GCEdenBlock* block = vm->gc->availableBlocks;
+        vm->gc->availableBlocks = block->next;
+        if (block != vm->gc->edenBlock) _aligned_free(block);
+    }
+    if (vm->gc->edenBlock != NULL) _aligned_free(vm->gc->edenBlock);
     freeGCGenerations(vm);
     free(vm->gc);
 }
 
-static GCRememberedEntry* findRememberedSetEntry(GCRememberedEntry* entries, int capacity, Obj* object) {
-    uint32_t hash = hashObject(object);
-    uint32_t index = (uint32_t)hash & ((uint32_t)capacity - 1);
+void linkObject(VM* vm, Obj* object, GCGenerationType generation) {
+    GCGeneration* currentHeap = GET_GC_GENERATION(generation);
+    object->next = currentHeap->objects;
+    currentHeap->objects = object;
+    if (generation >= GC_GENERATION_TYPE_PERMANENT || ++currentHeap->objectCount % GC_SWEEP_SEGMENT_SIZE != 0) return;
 
-    for (;;) {
-        GCRememberedEntry* entry = &entries[index];
-        if (entry->object == NULL || entry->object == object) {
-            return entry;
+    GCSweepSegments* sweepSegments = &currentHeap->sweepSegments;
+    if (sweepSegments->capacity < sweepSegments->count + 1) {
+        sweepSegments->capacity = GROW_CAPACITY(sweepSegments->capacity);
+        Obj** heads = (Obj**)realloc(sweepSegments->heads, sizeof(Obj*) * sweepSegments->capacity);
+        if (heads == NULL) {
+            fprintf(stderr, "Not enough memory to allocate for GC sweep segments.");
+            exit(74);
         }
-        index = (index + 1) & (capacity - 1);
+        sweepSegments->heads = heads;
     }
+    sweepSegments->heads[sweepSegments->count++] = object;
 }
 
-static bool rememberedSetGetObject(GCRememberedSet* rememberedSet, Obj* object) {
-    if (rememberedSet->count == 0) return false;
-    GCRememberedEntry* entry = findRememberedSetEntry(rememberedSet->entries, rememberedSet->capacity, object);
-    if (entry->object == NULL) return false;
-    return true;
-}
-
-static void rememberedSetAdjustCapacity(VM* vm, GCRememberedSet* remSet, int capacity) {
-    GCRememberedEntry* entries = ALLOCATE(GCRememberedEntry, capacity, remSet->generation);
-    for (int i = 0; i < capacity; i++) {
-        entries[i].object = NULL;
-    }
-
-    remSet->count = 0;
-    for (int i = 0; i < remSet->capacity; i++) {
-        GCRememberedEntry* entry = &remSet->entries[i];
-        if (entry->object == NULL) continue;
-        GCRememberedEntry* dest = findRememberedSetEntry(entries, capacity, entry->object);
-        dest->object = entry->object;
-        remSet->count++;
-    }
-
-    FREE_ARRAY(GCRememberedEntry, remSet->entries, remSet->capacity, remSet->generation);
-    remSet->entries = entries;
-    remSet->capacity = capacity;
-}
-
-static bool rememberedSetPutObject(VM* vm, GCRememberedSet* remSet, Obj* object) {
-    ENSURE_OBJECT_ID(object);
-    if (remSet->count + 1 > remSet->capacity * TABLE_MAX_LOAD) {
-        int capacity = GROW_CAPACITY(remSet->capacity);
-        rememberedSetAdjustCapacity(vm, remSet, capacity);
+void addToRememberedSet(VM* vm, Obj* object, GCGenerationType generation) {
+    GCRememberedSet* remSet = &vm->gc->generations[generation]->remSet;
+    if (remSet->capacity < remSet->count + 1) {
+        remSet->capacity = GROW_CAPACITY(remSet->capacity);
+        Obj** objects = (Obj**)realloc(remSet->objects, sizeof(Obj*) * remSet->capacity);
+        if (objects == NULL) {
+            fprintf(stderr, "Not enough memory to allocate for GC remembered set.");
+            exit(74);
+        }
+        remSet->objects = objects;
     }
 
-    GCRememberedEntry* entry = findRememberedSetEntry(remSet->entries, remSet->capacity, object);
-    bool isNewObject = entry->object == NULL;
-    if (isNewObject) {
 #ifdef DEBUG_LOG_GC
-        printf("%p added to remembered set ", (void*)object);
-        printValue(OBJ_VAL(object));
-        printf("\n");
+    printf("%p remembered for generation %d ", (void*)object, generation);
+    printValue(OBJ_VAL(object));
+    printf("\n");
 #endif
-        remSet->count++;
-    }
 
-    entry->object = object;
-    return isNewObject;
+    object->rememberedBits |= GC_REMEMBERED_BIT(generation);
+    remSet->objects[remSet->count++] = object;
 }
 
-void addToRememberedSet(VM* vm, Obj* object, GCGenerationType generation) {
-    rememberedSetPutObject(vm, &vm->gc->generations[generation]->remSet, object);
+static void pushWorkerGray(GCWorker* worker, Obj* object) {
+    if (worker->grayCapacity < worker->grayCount + 1) {
+        worker->grayCapacity = GROW_CAPACITY(worker->grayCapacity);
+        Obj** grayStack = (Obj**)realloc(worker->grayStack, sizeof(Obj*) * worker->grayCapacity);
+        if (grayStack == NULL) {
+            fprintf(stderr, "Not enough memory to allocate for GC worker gray stack.");
+            exit(74);
+        }
+        worker->grayStack = grayStack;
+    }
+    worker->grayStack[worker->grayCount++] = object;
 }
 
 void markObject(VM* vm, Obj* object, GCGenerationType generation) {
-    if (object == NULL || object->generation > generation || object->isMarked) return;
+    if (object == NULL || object->generation > generation) return;
+    if (vm->gc->isMarking && generation == GC_GENERATION_TYPE_OLD && object->generation < generation) return;
+    if (currentWorker != NULL) {
+        if (!GC_IS_MARKED(object) && GC_TRY_MARK(object)) pushWorkerGray(currentWorker, object);
+        return;
+    }
+    if (object->isMarked) return;
 
 #ifdef DEBUG_LOG_GC
     printf("%p mark ", (void*)object);
@@ -197,14 +533,6 @@ static void markGlobals(VM* vm, GCGenerationType generation) {
     markArray(vm, &vm->currentModule->varFields, generation);
 }
 
-void markRememberedSet(VM* vm, GCGenerationType generation) {
-    GCRememberedSet* remSet = &vm->gc->generations[generation]->remSet;
-    for (int i = 0; i < remSet->capacity; i++) {
-        GCRememberedEntry* entry = &remSet->entries[i];
-        markObject(vm, entry->object, GC_GENERATION_TYPE_PERMANENT);
-    }
-}
-
 static size_t sizeOfObject(Obj* object) {
     switch (object->category) {
         case OBJ_ARRAY: {
@@ -228,8 +556,10 @@ static size_t sizeOfObject(Obj* object) {
         }
         case OBJ_ENTRY: 
             return sizeof(ObjEntry);
-        case OBJ_EXCEPTION:
-            return sizeof(ObjException);
+        case OBJ_EXCEPTION: {
+            ObjException* exception = (ObjException*)object;
+            return sizeof(ObjException) + sizeof(TraceFrame) * exception->traceCount;
+        }
         case OBJ_FILE:
             return sizeof(ObjFile) + sizeof(uv_fs_t) * 4;
         case OBJ_FRAME: {
@@ -237,8 +567,8 @@ static size_t sizeOfObject(Obj* object) {
         }
         case OBJ_FUNCTION: {
             ObjFunction* function = (ObjFunction*)object;
-            return sizeof(ObjFunction) + sizeof(Chunk) + sizeof(uint8_t) * function->chunk.capacity + sizeof(int) * function->chunk.capacity
-                + sizeof(InlineCache) * function->chunk.identifiers.capacity + sizeof(Value) * function->chunk.constants.capacity
+            return sizeof(ObjFunction) + sizeof(Chunk) + sizeof(uint8_t) * function->chunk.capacity + sizeof(LineStart) * function->chunk.lineCapacity
+                + sizeof(InlineCache) * function->chunk.inlineCacheCapacity + sizeof(Value) * function->chunk.constants.capacity
                 + sizeof(Value) * function->chunk.identifiers.capacity;
         }
         case OBJ_GENERATOR: 
@@ -342,7 +672,7 @@ static void blackenObject(VM* vm, Obj* object, GCGenerationType generation) {
             for (int i = 0; i < dict->capacity; i++) {
                 ObjEntry* entry = &dict->entries[i];
                 markValue(vm, entry->key, generation);
-                markObject(vm, (Obj*)entry, generation);
+                markValue(vm, entry->value, generation);
             }
             break;
         }
@@ -356,6 +686,9 @@ static void blackenObject(VM* vm, Obj* object, GCGenerationType generation) {
             ObjException* exception = (ObjException*)object;
             markObject(vm, (Obj*)exception->message, generation);
             markObject(vm, (Obj*)exception->stacktrace, generation);
+            for (int i = 0; i < exception->traceCount; i++) {
+                markObject(vm, (Obj*)exception->traceFrames[i].closure, generation);
+            }
             break;
         }
         case OBJ_FILE: {
@@ -483,21 +816,15 @@ static void blackenObject(VM* vm, Obj* object, GCGenerationType generation) {
     }
 }
 
-static void freeObject(VM* vm, Obj* object) {
-#ifdef DEBUG_LOG_GC
-    printf("%p free category %d at generation %d\n", (void*)object, object->category, object->generation);
-#endif
-
+static size_t releaseObject(VM* vm, Obj* object) {
     switch (object->category) {
         case OBJ_ARRAY: {
             ObjArray* array = (ObjArray*)object;
             freeValueArray(vm, &array->elements);
-            FREE(ObjArray, object, object->generation);
-            break;
+            return sizeof(ObjArray);
         }
         case OBJ_BOUND_METHOD: 
-            FREE(ObjBoundMethod, object, object->generation);
-            break;       
+            return sizeof(ObjBoundMethod);
         case OBJ_CLASS: {
             ObjClass* _class = (ObjClass*)object;
             freeValueArray(vm, &_class->traits);
@@ -505,28 +832,25 @@ static void freeObject(VM* vm, Obj* object) {
             freeValueArray(vm, &_class->fields);
             freeTable(vm, &_class->methods);
             freeValueArray(vm, &_class->defaultInstanceFields);
-            FREE(ObjClass, object, object->generation);
-            break;
+            return sizeof(ObjClass);
         }
         case OBJ_CLOSURE: {
             ObjClosure* closure = (ObjClosure*)object;
             FREE_ARRAY(ObjUpvalue*, closure->upvalues, closure->upvalueCount, closure->obj.generation);
-            FREE(ObjClosure, object, object->generation);
-            break;
+            return sizeof(ObjClosure);
         }
         case OBJ_DICTIONARY: {
             ObjDictionary* dict = (ObjDictionary*)object;
             FREE_ARRAY(ObjEntry, dict->entries, dict->capacity, dict->obj.generation);
-            FREE(ObjDictionary, object, object->generation);
-            break;
+            return sizeof(ObjDictionary);
         }
         case OBJ_ENTRY: {
-            FREE(ObjEntry, object, object->generation);
-            break;
+            return sizeof(ObjEntry);
         }
         case OBJ_EXCEPTION: { 
-            FREE(ObjException, object, object->generation);
-            break;
+            ObjException* exception = (ObjException*)object;
+            FREE_ARRAY(TraceFrame, exception->traceFrames, exception->traceCount, object->generation);
+            return sizeof(ObjException);
         }
         case OBJ_FILE: {
             ObjFile* file = (ObjFile*)object;
@@ -546,36 +870,29 @@ static void freeObject(VM* vm, Obj* object) {
                 uv_fs_req_cleanup(file->fsWrite);
                 free(file->fsWrite);
             }
-            FREE(ObjFile, object, object->generation);
-            break;
+            return sizeof(ObjFile);
         }
         case OBJ_FRAME: {
-            FREE(ObjFrame, object, object->generation);
-            break;
+            return sizeof(ObjFrame);
         }
         case OBJ_FUNCTION: {
             ObjFunction* function = (ObjFunction*)object;
             freeChunk(vm, &function->chunk);
-            FREE(ObjFunction, object, object->generation);
-            break;
+            return sizeof(ObjFunction);
         }
         case OBJ_GENERATOR: {
-            FREE(ObjGenerator, object, object->generation);
-            break; 
+            return sizeof(ObjGenerator);
         }
         case OBJ_INSTANCE: {
             ObjInstance* instance = (ObjInstance*)object;
             freeValueArray(vm, &instance->fields);
-            FREE(ObjInstance, object, object->generation);
-            break;
+            return sizeof(ObjInstance);
         }
         case OBJ_ITERATOR: {
-            FREE(ObjIterator, object, object->generation);
-            break;
+            return sizeof(ObjIterator);
         }
         case OBJ_METHOD: {
-            FREE(ObjMethod, object, object->generation);
-            break;
+            return sizeof(ObjMethod);
         }
         case OBJ_MODULE: {
             ObjModule* module = (ObjModule*)object;
@@ -583,77 +900,77 @@ static void freeObject(VM* vm, Obj* object) {
             freeValueArray(vm, &module->valFields);
             freeIDMap(vm, &module->varIndexes);
             freeValueArray(vm, &module->varFields);
-            FREE(ObjModule, object, object->generation);
-            break;
+            return sizeof(ObjModule);
         }             
         case OBJ_NAMESPACE: { 
             ObjNamespace* _namespace = (ObjNamespace*)object;
             freeTable(vm, &_namespace->values);
-            FREE(ObjNamespace, object, object->generation);
-            break;
+            return sizeof(ObjNamespace);
         }
         case OBJ_NATIVE_FUNCTION:
-            FREE(ObjNativeFunction, object, object->generation);
-            break;
+            return sizeof(ObjNativeFunction);
         case OBJ_NATIVE_METHOD:
-            FREE(ObjNativeMethod, object, object->generation);
-            break;
+            return sizeof(ObjNativeMethod);
         case OBJ_NODE: {
-            FREE(ObjNode, object, object->generation);
-            break;
+            return sizeof(ObjNode);
         }
         case OBJ_PROMISE: {
             ObjPromise* promise = (ObjPromise*)object;
             freeValueArray(vm, &promise->handlers);
-            FREE(ObjPromise, object, object->generation);
-            break;
+            return sizeof(ObjPromise);
         }
         case OBJ_RANGE: {
-            FREE(ObjRange, object, object->generation);
-            break;
+            return sizeof(ObjRange);
         }
         case OBJ_RECORD: {
             ObjRecord* record = (ObjRecord*)object;
             if (record->freeFunction) record->freeFunction(record->data);
             else if(record->shouldFree) free(record->data);
-            FREE(ObjRecord, object, object->generation);
-            break;
+            return sizeof(ObjRecord);
         }
         case OBJ_STRING: {
             ObjString* string = (ObjString*)object;
-            reallocate(vm, object, sizeof(ObjString) + string->length + 1, 0, object->generation);
-            break;
+            return sizeof(ObjString) + string->length + 1;
         } 
         case OBJ_TIMER: { 
             ObjTimer* timer = (ObjTimer*)object;
-            FREE(ObjTimer, object, object->generation);
-            break;
+            return sizeof(ObjTimer);
         }
         case OBJ_TYPE: {
             ObjType* type = (ObjType*)object;
             freeValueArray(vm, &type->parameters);
-            FREE(ObjType, object, object->generation);
-            break;
+            return sizeof(ObjType);
         }
         case OBJ_UPVALUE:
-            FREE(ObjUpvalue, object, object->generation);
-            break;
+            return sizeof(ObjUpvalue);
         case OBJ_VALUE_INSTANCE: { 
             ObjValueInstance* instance = (ObjValueInstance*)object;
             freeValueArray(vm, &instance->fields);
-            FREE(ObjValueInstance, object, object->generation);
-            break;
+            return sizeof(ObjValueInstance);
         }
+        default:
+            return 0;
     }
 }
 
-static void promoteObject(VM* vm, Obj* object, GCGenerationType generation) {
-    GCGeneration* currentHeap = GET_GC_GENERATION(generation);
-    GCGeneration* nextHeap = GET_GC_GENERATION(generation + 1);
-    object->generation++;
-    object->next = nextHeap->objects;
-    nextHeap->objects = object;
+static void freeObject(VM* vm, Obj* object) {
+#ifdef DEBUG_LOG_GC
+    printf("%p free category %d at generation %d\n", (void*)object, object->category, object->generation);
+#endif
+
+    size_t size = releaseObject(vm, object);
+    if (size > 0) freeObjectMemory(vm, object, size);
+}
+
+void markRememberedSet(VM* vm, GCGenerationType generation) {
+    GCRememberedSet* remSet = &vm->gc->generations[generation]->remSet;
+    for (int i = 0; i < remSet->count; i++) {
+        blackenObject(vm, remSet->objects[i], generation);
+    }
+}
 
+static size_t advanceGeneration(Obj* object) {
+    object->generation++;
     switch (object->category) {
         case OBJ_ARRAY: {
             ObjArray* array = (ObjArray*)object;
@@ -707,9 +1024,17 @@ static void promoteObject(VM* vm, Obj* object, GCGenerationType generation) {
             break;
     }
 
-    size_t size = sizeOfObject(object);
+    return sizeOfObject(object);
+}
+
+static void promoteObject(VM* vm, Obj* object, GCGenerationType generation) {
+    GCGeneration* currentHeap = GET_GC_GENERATION(generation);
+    GCGeneration* nextHeap = GET_GC_GENERATION(generation + 1);
+    size_t size = advanceGeneration(object);
+    linkObject(vm, object, generation + 1);
     currentHeap->bytesAllocated -= size;
     nextHeap->bytesAllocated += size;
+    if (vm->gc->isMarking) markObject(vm, object, GC_GENERATION_TYPE_OLD);
 }
 
 static void markRoots(VM* vm, GCGenerationType generation) {
@@ -733,17 +1058,65 @@ static void markRoots(VM* vm, GCGenerationType generation) {
     markRememberedSet(vm, generation);
 }
 
-static void traceReferences(VM* vm, GCGenerationType generation) {
-    while (vm->gc->grayCount > 0) {
+static void traceReferences(VM* vm, GCGenerationType generation, int grayBase) {
+    GCWorkerPool* pool = vm->gc->workerPool;
+    if (pool != NULL && generation >= GC_GENERATION_TYPE_OLD) {
+        for (int i = grayBase; i < vm->gc->grayCount; i++) {
+            pushWorkerGray(&pool->workers[i % pool->workerCount], vm->gc->grayStack[i]);
+        }
+        vm->gc->grayCount = grayBase;
+        runGCJob(vm, GC_JOB_MARK, generation);
+        return;
+    }
+
+    while (vm->gc->grayCount > grayBase) {
         Obj* object = vm->gc->grayStack[--vm->gc->grayCount];
         blackenObject(vm, object, generation);
     }
 }
 
+static void removeWhiteStrings(VM* vm, GCGenerationType generation) {
+    if (vm->gc->workerPool != NULL && generation >= GC_GENERATION_TYPE_OLD) runGCJob(vm, GC_JOB_REMOVE_WHITE, generation);
+    else tableRemoveWhite(&vm->strings, generation);
+}
+
+static void finishParallelSweep(VM* vm, GCGeneration* nextHeap) {
+    GCWorkerPool* pool = vm->gc->workerPool;
+    for (int i = 0; i < pool->workerCount; i++) {
+        GCWorker* worker = &pool->workers[i];
+        if (worker->survivors != NULL) {
+            worker->survivorTail->next = nextHeap->objects;
+            nextHeap->objects = worker->survivors;
+            nextHeap->bytesAllocated += worker->survivorBytes;
+        }
+        worker->survivors = NULL;
+        worker->survivorTail = NULL;
+        worker->survivorBytes = 0;
+
+        for (int j = 0; j < worker->deadCount; j++) {
+            GCDeadObject* dead = &worker->deadObjects[j];
+            if (dead->size == 0) freeObject(vm, dead->object);
+            else freeObjectMemory(vm, dead->object, dead->size);
+        }
+        worker->deadCount = 0;
+    }
+}
+
 static void sweep(VM* vm, GCGenerationType generation) {
     GCGeneration* currentHeap = GET_GC_GENERATION(generation);
     GCGeneration* nextHeap = (generation >= GC_GENERATION_TYPE_PERMANENT) ? NULL : GET_GC_GENERATION(generation + 1);
     if (nextHeap == NULL) return;
+    currentHeap->objectCount = 0;
+
+    if (vm->gc->workerPool != NULL && generation >= GC_GENERATION_TYPE_OLD) {
+        runGCJob(vm, GC_JOB_SWEEP, generation);
+        finishParallelSweep(vm, nextHeap);
+        currentHeap->objects = NULL;
+        currentHeap->sweepSegments.count = 0;
+        currentHeap->bytesAllocated = 0;
+        return;
+    }
+
     Obj* object = currentHeap->objects;
 
     while (object != NULL) {
@@ -760,23 +1133,317 @@ static void sweep(VM* vm, GCGenerationType generation) {
         }
         currentHeap->objects = object;
     }
+    currentHeap->sweepSegments.count = 0;
+    currentHeap->bytesAllocated = 0;
 }
 
 static void processRememberedSet(VM* vm, GCGenerationType generation) {
-    if (generation >= GC_GENERATION_TYPE_OLD) return;
+    if (generation >= GC_GENERATION_TYPE_PERMANENT) return;
     GCRememberedSet* currentRemSet = &GET_GC_GENERATION(generation)->remSet;
-    GCRememberedSet* nextRemSet = &GET_GC_GENERATION(generation + 1)->remSet;
-
-    for (int i = 0; i < currentRemSet->capacity; i++) {
-        GCRememberedEntry* entry = &currentRemSet->entries[i];
-        if (entry->object != NULL) {
-            entry->object->isMarked = false;
-            if (entry->object->generation > generation + 1) {
-                rememberedSetPutObject(vm, nextRemSet, entry->object);
+
+    for (int i = 0; i < currentRemSet->count; i++) {
+        Obj* object = currentRemSet->objects[i];
+        object->rememberedBits &= ~GC_REMEMBERED_BIT(generation);
+        if (object->generation > generation + 1 && !(object->rememberedBits & GC_REMEMBERED_BIT(generation + 1))) {
+            addToRememberedSet(vm, object, generation + 1);
+        }
+    }
+    currentRemSet->count = 0;
+}
+
+static bool markIncrementally(VM* vm) {
+    uint64_t deadline = uv_hrtime() + (uint64_t)vm->config.gcMaxPause * 1000;
+    int count = 0;
+
+    while (vm->gc->grayCount > 0) {
+        Obj* object = vm->gc->grayStack[--vm->gc->grayCount];
+        blackenObject(vm, object, GC_GENERATION_TYPE_OLD);
+        if (++count % GC_MARK_STEP_CHECK_INTERVAL == 0 && uv_hrtime() >= deadline) break;
+    }
+
+#ifdef DEBUG_LOG_GC
+    printf("-- incremental mark step blackened %d objects, %d gray objects left\n", count, vm->gc->grayCount);
+#endif
+    return vm->gc->grayCount == 0;
+}
+
+static void markIdleCallback(uv_idle_t* idle) {
+    VM* vm = (VM*)idle->data;
+    if (markIncrementally(vm)) collectGarbage(vm, GC_GENERATION_TYPE_OLD);
+}
+
+static void startIncrementalMarking(VM* vm) {
+#ifdef DEBUG_LOG_GC
+    printf("-- incremental mark begin for generation %d\n", GC_GENERATION_TYPE_OLD);
+#endif
+
+    vm->gc->isMarking = true;
+    vm->gc->markDebt = 0;
+    markRoots(vm, GC_GENERATION_TYPE_OLD);
+    if (vm->gc->markIdle != NULL) uv_idle_start(vm->gc->markIdle, markIdleCallback);
+}
+
+static void finishIncrementalMarking(VM* vm) {
+    vm->gc->isMarking = false;
+    vm->gc->markDebt = 0;
+    if (vm->gc->markIdle != NULL) uv_idle_stop(vm->gc->markIdle);
+
+#ifdef DEBUG_LOG_GC
+    printf("-- incremental mark end for generation %d\n", GC_GENERATION_TYPE_OLD);
+#endif
+}
+
+static void shareGrayObjects(GCWorker* worker) {
+    GCWorkerPool* pool = worker->pool;
+    int count = worker->grayCount / 2;
+
+    uv_mutex_lock(&worker->lock);
+    if (worker->sharedCapacity < count) {
+        worker->sharedCapacity = count;
+        Obj** sharedStack = (Obj**)realloc(worker->sharedStack, sizeof(Obj*) * worker->sharedCapacity);
+        if (sharedStack == NULL) {
+            fprintf(stderr, "Not enough memory to allocate for GC worker shared stack.");
+            exit(74);
+        }
+        worker->sharedStack = sharedStack;
+    }
+    worker->grayCount -= count;
+    memcpy(worker->sharedStack, worker->grayStack + worker->grayCount, sizeof(Obj*) * count);
+    GC_ATOMIC_STORE(worker->sharedCount, count);
+    uv_mutex_unlock(&worker->lock);
+
+    uv_mutex_lock(&pool->lock);
+    GC_ATOMIC_STORE(pool->shareEpoch, pool->shareEpoch + 1);
+    uv_cond_broadcast(&pool->cond);
+    uv_mutex_unlock(&pool->lock);
+}
+
+static bool stealGrayObjects(GCWorker* worker) {
+    GCWorkerPool* pool = worker->pool;
+    for (int i = 0; i < pool->workerCount; i++) {
+        GCWorker* victim = &pool->workers[(worker->index + i) % pool->workerCount];
+        if (GC_ATOMIC_LOAD(victim->sharedCount) == 0) continue;
+
+        uv_mutex_lock(&victim->lock);
+        int count = victim->sharedCount;
+        for (int j = 0; j < count; j++) {
+            pushWorkerGray(worker, victim->sharedStack[j]);
+        }
+        GC_ATOMIC_STORE(victim->sharedCount, 0);
+        uv_mutex_unlock(&victim->lock);
+        if (count > 0) return true;
+    }
+    return false;
+}
+
+static bool waitForGrayObjects(GCWorker* worker, int shareEpoch) {
+    GCWorkerPool* pool = worker->pool;
+    uv_mutex_lock(&pool->lock);
+    if (pool->shareEpoch != shareEpoch) {
+        uv_mutex_unlock(&pool->lock);
+        return true;
+    }
+
+    GC_ATOMIC_STORE(pool->idleCount, pool->idleCount + 1);
+    if (pool->idleCount == pool->workerCount) {
+        pool->isMarkDone = true;
+        uv_cond_broadcast(&pool->cond);
+    }
+    while (!pool->isMarkDone && pool->shareEpoch == shareEpoch) {
+        uv_cond_wait(&pool->cond, &pool->lock);
+    }
+
+    bool hasWork = !pool->isMarkDone;
+    if (hasWork) GC_ATOMIC_STORE(pool->idleCount, pool->idleCount - 1);
+    uv_mutex_unlock(&pool->lock);
+    return hasWork;
+}
+
+static void markInParallel(GCWorker* worker) {
+    GCWorkerPool* pool = worker->pool;
+    while (true) {
+        while (worker->grayCount > 0) {
+            Obj* object = worker->grayStack[--worker->grayCount];
+            blackenObject(pool->vm, object, pool->generation);
+            if (worker->grayCount >= GC_WORKER_SHARE_THRESHOLD && GC_ATOMIC_LOAD(pool->idleCount) > 0 && GC_ATOMIC_LOAD(worker->sharedCount) == 0) {
+                shareGrayObjects(worker);
             }
         }
+
+        int shareEpoch = GC_ATOMIC_LOAD(pool->shareEpoch);
+        if (stealGrayObjects(worker)) continue;
+        if (!waitForGrayObjects(worker, shareEpoch)) return;
+    }
+}
+
+static void removeWhiteInParallel(GCWorker* worker) {
+    GCWorkerPool* pool = worker->pool;
+    Table* strings = &pool->vm->strings;
+    int start = (int)((int64_t)strings->capacity * worker->index / pool->workerCount);
+    int end = (int)((int64_t)strings->capacity * (worker->index + 1) / pool->workerCount);
+    tableRemoveWhiteRange(strings, pool->generation, start, end);
+}
+
+static void addDeadObject(GCWorker* worker, Obj* object, size_t size) {
+    if (worker->deadCapacity < worker->deadCount + 1) {
+        worker->deadCapacity = GROW_CAPACITY(worker->deadCapacity);
+        GCDeadObject* deadObjects = (GCDeadObject*)realloc(worker->deadObjects, sizeof(GCDeadObject) * worker->deadCapacity);
+        if (deadObjects == NULL) {
+            fprintf(stderr, "Not enough memory to allocate for GC worker dead objects.");
+            exit(74);
+        }
+        worker->deadObjects = deadObjects;
+    }
+    worker->deadObjects[worker->deadCount].object = object;
+    worker->deadObjects[worker->deadCount].size = size;
+    worker->deadCount++;
+}
+
+static void sweepSegment(GCWorker* worker, Obj* object, Obj* end) {
+    VM* vm = worker->pool->vm;
+    while (object != end) {
+        Obj* next = object->next;
+        if (object->isMarked) {
+            object->isMarked = false;
+            worker->survivorBytes += advanceGeneration(object);
+            if (worker->survivorTail == NULL) worker->survivorTail = object;
+            object->next = worker->survivors;
+            worker->survivors = object;
+        }
+        else if (object->category == OBJ_RECORD && ((ObjRecord*)object)->freeFunction != NULL) {
+            addDeadObject(worker, object, 0);
+        }
+        else {
+            size_t size = releaseObject(vm, object);
+            if (object->isBumpAllocated || object->isSlabAllocated) addDeadObject(worker, object, size);
+            else if (size > 0) reallocate(vm, object, size, 0, object->generation);
+        }
+        object = next;
+    }
+}
+
+static void sweepInParallel(GCWorker* worker) {
+    GCWorkerPool* pool = worker->pool;
+    GCGeneration* currentHeap = pool->vm->gc->generations[pool->generation];
+    GCSweepSegments* sweepSegments = &currentHeap->sweepSegments;
+
+    while (true) {
+        uv_mutex_lock(&pool->lock);
+        int segment = pool->nextSegment++;
+        uv_mutex_unlock(&pool->lock);
+        if (segment > sweepSegments->count) return;
+
+        Obj* start = (segment == 0) ? currentHeap->objects : sweepSegments->heads[sweepSegments->count - segment];
+        Obj* end = (segment == sweepSegments->count) ? NULL : sweepSegments->heads[sweepSegments->count - segment - 1];
+        sweepSegment(worker, start, end);
+    }
+}
+
+static void runWorkerJob(GCWorker* worker) {
+    currentWorker = worker;
+    switch (worker->pool->job) {
+        case GC_JOB_MARK:
+            markInParallel(worker);
+            break;
+        case GC_JOB_REMOVE_WHITE:
+            removeWhiteInParallel(worker);
+            break;
+        case GC_JOB_SWEEP:
+            sweepInParallel(worker);
+            break;
+        default:
+            break;
     }
-    freeGCRememeberedSet(vm, currentRemSet);
+    currentWorker = NULL;
+}
+
+static void runGCWorkerThread(void* data) {
+    GCWorker* worker = (GCWorker*)data;
+    GCWorkerPool* pool = worker->pool;
+    while (true) {
+        uv_barrier_wait(&pool->jobStart);
+        if (pool->job == GC_JOB_EXIT) return;
+        runWorkerJob(worker);
+        uv_barrier_wait(&pool->jobEnd);
+    }
+}
+
+static void runGCJob(VM* vm, GCJobType job, GCGenerationType generation) {
+    GCWorkerPool* pool = vm->gc->workerPool;
+    pool->job = job;
+    pool->generation = generation;
+    pool->idleCount = 0;
+    pool->isMarkDone = false;
+    pool->nextSegment = 0;
+
+    uv_barrier_wait(&pool->jobStart);
+    runWorkerJob(&pool->workers[0]);
+    uv_barrier_wait(&pool->jobEnd);
+
+    for (int i = 0; i < pool->workerCount; i++) {
+        GCWorker* worker = &pool->workers[i];
+        for (int j = 0; j < GC_GENERATION_TYPE_COUNT; j++) {
+            GCGeneration* heap = GET_GC_GENERATION(j);
+            heap->bytesAllocated = (heap->bytesAllocated < worker->freedBytes[j]) ? 0 : heap->bytesAllocated - worker->freedBytes[j];
+            worker->freedBytes[j] = 0;
+        }
+    }
+}
+
+static GCWorkerPool* newGCWorkerPool(VM* vm, int workerCount) {
+    GCWorkerPool* pool = ALLOCATE_STRUCT(GCWorkerPool);
+    GCWorker* workers = (GCWorker*)calloc((size_t)workerCount + 1, sizeof(GCWorker));
+    if (pool == NULL || workers == NULL) {
+        fprintf(stderr, "Not enough memory to allocate worker pool for garbage collector.");
+        exit(74);
+    }
+
+    pool->vm = vm;
+    pool->workers = workers;
+    pool->workerCount = workerCount + 1;
+    pool->job = GC_JOB_EXIT;
+    pool->generation = GC_GENERATION_TYPE_OLD;
+    pool->idleCount = 0;
+    pool->shareEpoch = 0;
+    pool->isMarkDone = false;
+    pool->nextSegment = 0;
+    uv_barrier_init(&pool->jobStart, pool->workerCount);
+    uv_barrier_init(&pool->jobEnd, pool->workerCount);
+    uv_mutex_init(&pool->lock);
+    uv_cond_init(&pool->cond);
+
+    for (int i = 0; i < pool->workerCount; i++) {
+        GCWorker* worker = &workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        uv_mutex_init(&worker->lock);
+        if (i > 0 && uv_thread_create(&worker->thread, runGCWorkerThread, worker) != 0) {
+            fprintf(stderr, "Failed to start worker thread for garbage collector.");
+            exit(74);
+        }
+    }
+    return pool;
+}
+
+static void freeGCWorkerPool(GCWorkerPool* pool) {
+    pool->job = GC_JOB_EXIT;
+    uv_barrier_wait(&pool->jobStart);
+
+    for (int i = 0; i < pool->workerCount; i++) {
+        GCWorker* worker = &pool->workers[i];
+        if (i > 0) uv_thread_join(&worker->thread);
+        uv_mutex_destroy(&worker->lock);
+        free(worker->grayStack);
+        free(worker->sharedStack);
+        free(worker->deadObjects);
+    }
+
+    uv_cond_destroy(&pool->cond);
+    uv_mutex_destroy(&pool->lock);
+    uv_barrier_destroy(&pool->jobEnd);
+    uv_barrier_destroy(&pool->jobStart);
+    free(pool->workers);
+    free(pool);
 }
 
 void collectGarbage(VM* vm, GCGenerationType generation) {
@@ -790,11 +1457,13 @@ void collectGarbage(VM* vm, GCGenerationType generation) {
     size_t nextBefore = (nextHeap == NULL) ? 0 : nextHeap->bytesAllocated;
 #endif
 
+    int grayBase = (generation < GC_GENERATION_TYPE_OLD) ? vm->gc->grayCount : 0;
     markRoots(vm, generation);
-    traceReferences(vm, generation);
-    tableRemoveWhite(&vm->strings);
+    traceReferences(vm, generation, grayBase);
+    removeWhiteStrings(vm, generation);
     sweep(vm, generation);
     processRememberedSet(vm, generation);
+    if (generation == GC_GENERATION_TYPE_OLD && vm->gc->isMarking) finishIncrementalMarking(vm);
 
 #ifdef DEBUG_LOG_GC
     printf("-- gc end for generation %d\n", generation);
@@ -807,6 +1476,13 @@ void collectGarbage(VM* vm, GCGenerationType generation) {
     if (nextHeap != NULL) {
         printf("   next heap uses %zu bytes, heap size %zu bytes\n", nextHeap->bytesAllocated, nextHeap->heapSize);
     }
+
+    for (int i = GC_GENERATION_TYPE_OLD; i <= GC_GENERATION_TYPE_PERMANENT; i++) {
+        GCSlabHeap* slabHeap = &GET_GC_GENERATION(i)->slabHeap;
+        size_t pageBytes = slabHeap->pageCount * GC_SLAB_PAGE_SIZE;
+        printf("   slab heap %d uses %zu pages, %zu slot bytes for %zu requested bytes, %.1f%% fragmented\n", i, slabHeap->pageCount,
+            slabHeap->slotBytes, slabHeap->requestedBytes, pageBytes == 0 ? 0.0 : 100.0 * (double)(pageBytes - slabHeap->requestedBytes) / (double)pageBytes);
+    }
 #endif
 }
 
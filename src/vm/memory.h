@@ -7,28 +7,131 @@
 #include "vm.h"
 
 #define GC_GENERATION_TYPE_COUNT 4
+#define GC_EDEN_BLOCK_SIZE 65536
+#define GC_EDEN_MAX_OBJECT_SIZE 512
+#define GC_EDEN_GRANULE_SIZE 8
+#define GC_EDEN_GRANULE_COUNT (GC_EDEN_BLOCK_SIZE / GC_EDEN_GRANULE_SIZE)
+#define GC_SLAB_PAGE_SIZE 16384
+#define GC_SLAB_SIZE_CLASS_COUNT 32
+#define GC_SLAB_SIZE_CLASS_GRANULARITY 16
+#define GC_SLAB_MAX_OBJECT_SIZE (GC_SLAB_SIZE_CLASS_COUNT * GC_SLAB_SIZE_CLASS_GRANULARITY)
+#define GC_MARK_STEP_SIZE 65536
+#define GC_MARK_STEP_CHECK_INTERVAL 64
+#define GC_SWEEP_SEGMENT_SIZE 4096
+#define GC_WORKER_SHARE_THRESHOLD 64
 
 typedef struct {
-    Obj* object;
-} GCRememberedEntry;
+    int count;
+    int capacity;
+    Obj** objects;
+} GCRememberedSet;
 
 typedef struct {
     int count;
     int capacity;
+    Obj** heads;
+} GCSweepSegments;
+
+typedef struct GCEdenBlock {
+    struct GCEdenBlock* next;
+    int objectCount;
+    int liveBytes;
+    bool isAvailable;
+    uint64_t granules[GC_EDEN_GRANULE_COUNT / 64];
+} GCEdenBlock;
+
+typedef struct GCSlabSlot {
+    struct GCSlabSlot* next;
+} GCSlabSlot;
+
+typedef struct GCSlabPage {
+    struct GCSlabPage* next;
+    struct GCSlabPage* previous;
+    GCSlabSlot* freeSlots;
+    uint8_t* top;
     GCGenerationType generation;
-    GCRememberedEntry* entries;
-} GCRememberedSet;
+    int sizeClass;
+    int slotCount;
+    int liveCount;
+} GCSlabPage;
+
+typedef struct {
+    GCSlabPage* pages[GC_SLAB_SIZE_CLASS_COUNT];
+    size_t pageCount;
+    size_t slotBytes;
+    size_t requestedBytes;
+} GCSlabHeap;
 
 typedef struct {
     GCGenerationType type;
     Obj* objects;
+    size_t objectCount;
+    GCSweepSegments sweepSegments;
     GCRememberedSet remSet;
+    GCSlabHeap slabHeap;
     size_t bytesAllocated;
     size_t heapSize;
 } GCGeneration;
 
+typedef enum {
+    GC_JOB_MARK,
+    GC_JOB_REMOVE_WHITE,
+    GC_JOB_SWEEP,
+    GC_JOB_EXIT
+} GCJobType;
+
+typedef struct {
+    Obj* object;
+    size_t size;
+} GCDeadObject;
+
+typedef struct GCWorker {
+    struct GCWorkerPool* pool;
+    uv_thread_t thread;
+    uv_mutex_t lock;
+    int index;
+    int grayCount;
+    int grayCapacity;
+    Obj** grayStack;
+    int sharedCount;
+    int sharedCapacity;
+    Obj** sharedStack;
+    int deadCount;
+    int deadCapacity;
+    GCDeadObject* deadObjects;
+    Obj* survivors;
+    Obj* survivorTail;
+    size_t survivorBytes;
+    size_t freedBytes[GC_GENERATION_TYPE_COUNT];
+} GCWorker;
+
+typedef struct GCWorkerPool {
+    VM* vm;
+    GCWorker* workers;
+    int workerCount;
+    uv_barrier_t jobStart;
+    uv_barrier_t jobEnd;
+    uv_mutex_t lock;
+    uv_cond_t cond;
+    GCJobType job;
+    GCGenerationType generation;
+    int idleCount;
+    int shareEpoch;
+    bool isMarkDone;
+    int nextSegment;
+} GCWorkerPool;
+
 struct GC {
     GCGeneration* generations[4];
+    GCEdenBlock* edenBlock;
+    GCEdenBlock* availableBlocks;
+    uint8_t* edenTop;
+    uint8_t* edenEnd;
+    int availableBlockCount;
+    bool isMarking;
+    size_t markDebt;
+    uv_idle_t* markIdle;
+    GCWorkerPool* workerPool;
     int grayCount;
     int grayCapacity;
     Obj** grayStack;
@@ -53,17 +156,24 @@ struct GC {
 
 #define GET_GC_GENERATION(generation) vm->gc->generations[generation]
 
+#define GC_REMEMBERED_BIT(generation) ((uint8_t)(1 << (generation)))
+
 #define PROCESS_WRITE_BARRIER(source, target) \
     do { \
        if (sourceOlderThanTarget(source, target)) { \
-           GCGenerationType generation = OBJ_GEN(target); \
-           addToRememberedSet(vm, source, generation); \
+           if (!((source)->rememberedBits & GC_REMEMBERED_BIT(OBJ_GEN(target)))) addToRememberedSet(vm, source, OBJ_GEN(target)); \
+       } \
+       else if (vm->gc->isMarking && (source)->isMarked) { \
+           markValue(vm, target, GC_GENERATION_TYPE_OLD); \
        } \
     } while (false)
 
 void* reallocate(VM* vm, void* pointer, size_t oldSize, size_t newSize, GCGenerationType generation);
+void* bumpAllocate(VM* vm, size_t size);
+void* slabAllocate(VM* vm, size_t size, GCGenerationType generation);
 GC* newGC(VM* vm);
 void freeGC(VM* vm);
+void linkObject(VM* vm, Obj* object, GCGenerationType generation);
 void addToRememberedSet(VM* vm, Obj* object, GCGenerationType generation);
 void markObject(VM* vm, Obj* object, GCGenerationType generation);
 void markValue(VM* vm, Value value, GCGenerationType generation);
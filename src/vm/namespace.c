@@ -157,12 +157,12 @@ InterpretResult runModule(VM* vm, ObjModule* module, bool isRootModule) {
     }
 }
 
-bool loadModule(VM* vm, ObjString* path) {
+bool loadModule(VM* vm, ObjString* path, bool fromSource) {
     ObjModule* lastModule = vm->currentModule;
     vm->currentModule = newModule(vm, path);
 
     char* source = readFile(path->chars);
-    ObjFunction* function = compile(vm, source);
+    ObjFunction* function = compileModule(vm, path, source, fromSource);
     free(source);
     if (function == NULL) return false;
     push(vm, OBJ_VAL(function));
@@ -14,6 +14,6 @@ bool sourceDirectoryExists(ObjString* directoryPath);
 ObjString* locateSourceDirectory(VM* vm, ObjString* shortName, ObjNamespace* enclosingNamespace);
 ObjString* locateSourceDirectoryFromFullName(VM* vm, ObjString* fullName);
 InterpretResult runModule(VM* vm, ObjModule* module, bool isRootModule);
-bool loadModule(VM* vm, ObjString* path);
+bool loadModule(VM* vm, ObjString* path, bool fromSource);
 
 #endif // !clox_namespace_h
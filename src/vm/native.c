@@ -143,6 +143,7 @@ void defineNativeMethod(VM* vm, ObjClass* klass, const char* name, int arity, bo
     ObjNativeMethod* nativeMethod = newNativeMethod(vm, klass, methodName, arity, isAsync, method);
     push(vm, OBJ_VAL(nativeMethod));
     tableSet(vm, &klass->methods, methodName, OBJ_VAL(nativeMethod));
+    klass->methodVersion++;
     pop(vm);
 
     va_list args;
@@ -7,17 +7,28 @@
 #include "../common/os.h"
 
 Obj* allocateObject(VM* vm, size_t size, ObjCategory category, ObjClass* klass, GCGenerationType generation) {
-    Obj* object = (Obj*)reallocate(vm, NULL, 0, size, generation);
+    bool isBumpAllocated = generation == GC_GENERATION_TYPE_EDEN && size <= GC_EDEN_MAX_OBJECT_SIZE;
+    bool isSlabAllocated = generation >= GC_GENERATION_TYPE_OLD && size <= GC_SLAB_MAX_OBJECT_SIZE;
+    Obj* object = NULL;
+    if (isBumpAllocated) object = (Obj*)bumpAllocate(vm, size);
+    else if (isSlabAllocated) object = (Obj*)slabAllocate(vm, size, generation);
+    else object = (Obj*)reallocate(vm, NULL, 0, size, generation);
     object->category = category;
     object->klass = klass;
     object->isMarked = false;
+    object->isBumpAllocated = isBumpAllocated;
+    object->isSlabAllocated = isSlabAllocated;
+    object->rememberedBits = 0;
     object->generation = generation;
     object->objectID = 0;
     object->shapeID = getDefaultShapeIDForObject(object);
 
-    GCGeneration* currentHeap = GET_GC_GENERATION(generation);
-    object->next = currentHeap->objects;
-    currentHeap->objects = object;
+    linkObject(vm, object, generation);
+
+    if (vm->gc->isMarking && generation == GC_GENERATION_TYPE_OLD) {
+        object->isMarked = true;
+        addToRememberedSet(vm, object, generation);
+    }
 
 #ifdef DEBUG_LOG_GC
     printf("%p allocate %zu for %d at generation %d\n", (void*)object, size, category, generation);
@@ -92,13 +103,16 @@ ObjClass* newClass(VM* vm, ObjString* name, ObjCategory classType) {
 }
 
 void initClosure(VM* vm, ObjClosure* closure, ObjFunction* function) {
+    closure->function = function;
+    closure->module = vm->currentModule;
+    closure->upvalues = NULL;
+    closure->upvalueCount = 0;
+
     ObjUpvalue** upvalues = ALLOCATE(ObjUpvalue*, function->upvalueCount, closure->obj.generation);
     for (int i = 0; i < function->upvalueCount; i++) {
         upvalues[i] = NULL;
     }
 
-    closure->function = function;
-    closure->module = vm->currentModule;
     closure->upvalues = upvalues;
     closure->upvalueCount = function->upvalueCount;
 }
@@ -130,7 +144,9 @@ ObjException* newException(VM* vm, ObjString* message, ObjClass* klass) {
     ObjException* exception = ALLOCATE_OBJ(ObjException, OBJ_EXCEPTION, klass);
     push(vm, OBJ_VAL(exception));
     exception->message = message;
-    exception->stacktrace = newArray(vm);
+    exception->stacktrace = NULL;
+    exception->traceFrames = NULL;
+    exception->traceCount = 0;
     pop(vm);
     return exception;
 }
@@ -154,15 +170,10 @@ ObjFrame* newFrame(VM* vm, CallFrame* callFrame) {
     frame->closure = callFrame->closure;
     frame->ip = callFrame->ip;
     frame->slotCount = callFrame->closure->function->arity + 1; 
-    frame->handlerCount = callFrame->handlerCount;
 
     for (int i = 0; i < frame->slotCount; i++) {
         frame->slots[i] = peek(vm, callFrame->closure->function->arity - i);
     }
-
-    for (int i = 0; i < frame->handlerCount; i++) {
-        frame->handlerStack[i] = callFrame->handlerStack[i];
-    }
     return frame;
 }
 
@@ -175,6 +186,7 @@ ObjFunction* newFunction(VM* vm, ObjString* name, bool isAsync) {
     function->upvalueCount = 0;
     function->isGenerator = false;
     function->isAsync = isAsync;
+    function->interceptor = INTERCEPTOR_NONE;
     function->name = name;
     initChunk(&function->chunk, function->obj.generation);
     return function;
@@ -219,6 +231,7 @@ ObjMethod* newMethod(VM* vm, ObjClass* behavior, ObjClosure* closure) {
 ObjModule* newModule(VM* vm, ObjString* path) {
     ObjModule* module = ALLOCATE_OBJ_GEN(ObjModule, OBJ_MODULE, NULL, GC_GENERATION_TYPE_PERMANENT);
     module->path = path;
+    PROCESS_WRITE_BARRIER((Obj*)module, OBJ_VAL(path));
     module->closure = NULL;
     module->isNative = false;
 
@@ -130,6 +130,9 @@ struct Obj {
     ObjCategory category;
     ObjClass* klass;
     bool isMarked;
+    bool isBumpAllocated;
+    bool isSlabAllocated;
+    uint8_t rememberedBits;
     GCGenerationType generation;
     struct Obj* next;
 };
@@ -151,6 +154,7 @@ typedef struct {
     int upvalueCount;
     bool isGenerator;
     bool isAsync;
+    InterceptorType interceptor;
     Chunk chunk;
     ObjString* name;
 } ObjFunction;
@@ -243,14 +247,17 @@ typedef struct {
     bool isNative;
 } ObjBoundMethod;
 
+typedef struct {
+    ObjClosure* closure;
+    int instruction;
+} TraceFrame;
+
 typedef struct {
     Obj obj;
     ObjClosure* closure;
     uint8_t* ip;
     Value slots[UINT8_MAX];
     uint8_t slotCount;
-    uint8_t handlerCount;
-    ExceptionHandler handlerStack[UINT4_MAX];
 } ObjFrame;
 
 struct ObjGenerator {
@@ -276,6 +283,22 @@ typedef struct {
     bool isRunning;
 } ObjTimer;
 
+typedef enum {
+    OPERATOR_ADD,
+    OPERATOR_SUBTRACT,
+    OPERATOR_MULTIPLY,
+    OPERATOR_DIVIDE,
+    OPERATOR_MODULO,
+    OPERATOR_EQUAL,
+    OPERATOR_GREATER,
+    OPERATOR_LESS,
+    OPERATOR_GET_SUBSCRIPT,
+    OPERATOR_SET_SUBSCRIPT,
+    OPERATOR_RANGE,
+    OPERATOR_CALL,
+    OPERATOR_COUNT
+} OperatorType;
+
 struct ObjClass {
     Obj obj;
     ObjCategory classType;
@@ -291,6 +314,9 @@ struct ObjClass {
     IDMap indexes;
     ValueArray fields;
     Table methods;
+    int methodVersion;
+    Value operators[OPERATOR_COUNT];
+    int operatorVersion;
     int defaultShapeID;
     ValueArray defaultInstanceFields;
 };
@@ -307,6 +333,8 @@ struct ObjException {
     Obj obj;
     ObjString* message;
     ObjArray* stacktrace;
+    TraceFrame* traceFrames;
+    int traceCount;
 };
 
 struct ObjModule {
@@ -9,7 +9,7 @@
 #include "string.h"
 #include "vm.h"
 
-static ObjString* allocateString(VM* vm, char* chars, int length, uint32_t hash, GCGenerationType generation) {
+static ObjString* allocateString(VM* vm, const char* chars, int length, uint32_t hash, GCGenerationType generation) {
     ObjString* string = ALLOCATE_STRING_GEN(length, vm->stringClass, generation);
     string->length = length;
     string->hash = hash;
@@ -59,11 +59,7 @@ ObjString* copyString(VM* vm, const char* chars, int length) {
     uint32_t hash = hashString(chars, length);
     ObjString* interned = tableFindString(&vm->strings, chars, length, hash);
     if (interned != NULL) return interned;
-
-    char* heapChars = ALLOCATE(char, (size_t)length + 1, GC_GENERATION_TYPE_EDEN);
-    memcpy(heapChars, chars, length);
-    heapChars[length] = '\0';
-    return allocateString(vm, heapChars, length, hash, GC_GENERATION_TYPE_EDEN);
+    return allocateString(vm, chars, length, hash, GC_GENERATION_TYPE_EDEN);
 }
 
 ObjString* copyStringPerma(VM* vm, const char* chars, int length) {
@@ -99,6 +99,13 @@ bool tableDelete(Table* table, ObjString* key) {
 }
 
 void tableAddAll(VM* vm, Table* from, Table* to) {
+    if (to->count == 0 && from->count > 0) {
+        adjustCapacity(vm, to, from->capacity);
+        memcpy(to->entries, from->entries, sizeof(Entry) * from->capacity);
+        to->count = from->count;
+        return;
+    }
+
     for (int i = 0; i < from->capacity; i++) {
         Entry* entry = &from->entries[i];
         if (entry->key != NULL) {
@@ -123,11 +130,16 @@ ObjString* tableFindString(Table* table, const char* chars, int length, uint32_t
     }
 }
 
-void tableRemoveWhite(Table* table) {
-    for (int i = 0; i < table->capacity; i++) {
+void tableRemoveWhite(Table* table, GCGenerationType generation) {
+    tableRemoveWhiteRange(table, generation, 0, table->capacity);
+}
+
+void tableRemoveWhiteRange(Table* table, GCGenerationType generation, int start, int end) {
+    for (int i = start; i < end; i++) {
         Entry* entry = &table->entries[i];
-        if (entry->key != NULL && !entry->key->obj.isMarked && entry->key->obj.generation < GC_GENERATION_TYPE_PERMANENT) {
-            tableDelete(table, entry->key);
+        if (entry->key != NULL && !entry->key->obj.isMarked && entry->key->obj.generation <= generation && entry->key->obj.generation < GC_GENERATION_TYPE_PERMANENT) {
+            entry->key = NULL;
+            entry->value = BOOL_VAL(true);
         }
     }
 }
@@ -26,7 +26,8 @@ bool tableSet(VM* vm, Table* table, ObjString* key, Value value);
 bool tableDelete(Table* table, ObjString* key);
 void tableAddAll(VM* vm, Table* from, Table* to);
 ObjString* tableFindString(Table* table, const char* chars, int length, uint32_t hash);
-void tableRemoveWhite(Table* table);
+void tableRemoveWhite(Table* table, GCGenerationType generation);
+void tableRemoveWhiteRange(Table* table, GCGenerationType generation, int start, int end);
 void markTable(VM* vm, Table* table, GCGenerationType generation);
 
 #endif // !clox_table_h
\ No newline at end of file
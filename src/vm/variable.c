@@ -12,72 +12,66 @@ bool matchVariableName(ObjString* sourceString, const char* targetChars, int tar
     return memcmp(sourceString->chars, targetChars, targetLength) == 0;
 }
 
-static bool loadGlobalValue(VM* vm, Chunk* chunk, uint8_t byte, Value* value) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+static bool loadGlobalValue(VM* vm, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value* value) {
     ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
     int index;
     if (idMapGet(&vm->currentModule->valIndexes, name, &index)) {
 #ifdef DEBUG_TRACE_CACHE
-        printf("Cache miss for getting immutable global variable: '%s' at index %d.\n", name->chars, inlineCache->index);
+        printf("Cache miss for getting immutable global variable: '%s' at index %d.\n", name->chars, index);
 #endif 
         *value = vm->currentModule->valFields.values[index];
-        writeInlineCache(inlineCache, CACHE_GVAL, (int)byte, index);
+        if (inlineCache != NULL) writeInlineCache(inlineCache, CACHE_GVAL, (int)byte, index);
         return true;
     }
     return false;
 }
 
-static bool loadGlobalVariable(VM* vm, Chunk* chunk, uint8_t byte, Value* value) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+static bool loadGlobalVariable(VM* vm, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value* value) {
     ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
     int index;
     if (idMapGet(&vm->currentModule->varIndexes, name, &index)) {
 #ifdef DEBUG_TRACE_CACHE
-        printf("Cache miss for getting mutable global variable: '%s' at index %d.\n", name->chars, inlineCache->index);
+        printf("Cache miss for getting mutable global variable: '%s' at index %d.\n", name->chars, index);
 #endif 
         *value = vm->currentModule->varFields.values[index];
-        writeInlineCache(inlineCache, CACHE_GVAR, (int)byte, index);
+        if (inlineCache != NULL) writeInlineCache(inlineCache, CACHE_GVAR, (int)byte, index);
         return true;
     }
     return false;
 }
 
-static bool loadGlobalFromTable(VM* vm, Chunk* chunk, uint8_t byte, Value* value) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+static bool loadGlobalFromTable(VM* vm, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value* value) {
     ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
-    if (loadGlobalValue(vm, chunk, byte, value)) return true;
-    else if (loadGlobalVariable(vm, chunk, byte, value)) return true;
+    if (loadGlobalValue(vm, chunk, byte, inlineCache, value)) return true;
+    else if (loadGlobalVariable(vm, chunk, byte, inlineCache, value)) return true;
     else if (tableGet(&vm->currentNamespace->values, name, value)) return true;
     else return tableGet(&vm->rootNamespace->values, name, value);
 }
 
-static bool loadGlobalFromCache(VM* vm, Chunk* chunk, uint8_t byte, Value* value) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
-    if (inlineCache->id == byte) {
-        switch (inlineCache->type) {
-            case CACHE_GVAL: {
+static bool loadGlobalFromCache(VM* vm, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value* value) {
+    InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_GVAL, byte);
+    if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-                printf("Cache hit for getting immutable global variable: '%s' at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), inlineCache->index);
+        printf("Cache hit for getting immutable global variable: '%s' at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), entry->index);
 #endif 
-                *value = vm->currentModule->valFields.values[inlineCache->index];
-                return true;
-            }
-            case CACHE_GVAR: {
+        *value = vm->currentModule->valFields.values[entry->index];
+        return true;
+    }
+
+    entry = getInlineCacheEntry(inlineCache, CACHE_GVAR, byte);
+    if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-                printf("Cache hit for getting mutable global variable: '%s' at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), inlineCache->index);
+        printf("Cache hit for getting mutable global variable: '%s' at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), entry->index);
 #endif 
-                *value = vm->currentModule->varFields.values[inlineCache->index];
-                return true;
-            }
-            default: return loadGlobalFromTable(vm, chunk, byte, value);
-        }
+        *value = vm->currentModule->varFields.values[entry->index];
+        return true;
     }
-    else return loadGlobalFromTable(vm, chunk, byte, value);
+    return loadGlobalFromTable(vm, chunk, byte, inlineCache, value);
 }
 
-bool loadGlobal(VM* vm, Chunk* chunk, uint8_t byte, Value* value) {
-    if (chunk->inlineCaches[byte].type != CACHE_NONE) return loadGlobalFromCache(vm, chunk, byte, value);
-    return loadGlobalFromTable(vm, chunk, byte, value);
+bool loadGlobal(VM* vm, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value* value) {
+    if (inlineCache != NULL && inlineCache->count > 0) return loadGlobalFromCache(vm, chunk, byte, inlineCache, value);
+    return loadGlobalFromTable(vm, chunk, byte, inlineCache, value);
 }
 
 bool hasInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_t byte) {
@@ -131,7 +125,7 @@ static bool getGenericInstanceVariableByIndex(VM* vm, Obj* object, int index) {
         case OBJ_EXCEPTION: {
             ObjException* exception = (ObjException*)object;
             if (index == 0) push(vm, OBJ_VAL(exception->message));
-            else if (index == 1) push(vm, OBJ_VAL(exception->stacktrace));
+            else if (index == 1) push(vm, OBJ_VAL(getStackTrace(vm, exception)));
             else getAndPushGenericInstanceVariableByIndex(vm, object, index);
             return true;
         }
@@ -283,7 +277,7 @@ bool getGenericInstanceVariableByName(VM* vm, Obj* object, ObjString* name) {
         case OBJ_EXCEPTION: {
             ObjException* exception = (ObjException*)object;
             if (matchVariableName(name, "message", 7)) push(vm, OBJ_VAL(exception->message));
-            else if (matchVariableName(name, "stacktrace", 10)) push(vm, OBJ_VAL(exception->stacktrace));
+            else if (matchVariableName(name, "stacktrace", 10)) push(vm, OBJ_VAL(getStackTrace(vm, exception)));
             else return getAndPushGenericInstanceVariableByName(vm, object, name);
             return true;
         }
@@ -383,15 +377,15 @@ bool getGenericInstanceVariableByName(VM* vm, Obj* object, ObjString* name) {
     return false;
 }
 
-static bool getGenericInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_t byte) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+static bool getGenericInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_t byte, InlineCache* inlineCache) {
     int shapeID = object->shapeID;
     pop(vm);
-    if (inlineCache->type == CACHE_IVAR && inlineCache->id == shapeID) {
+    InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_IVAR, shapeID);
+    if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-        printf("Cache hit for getting instance variable: '%s' from Shape ID %d at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), inlineCache->id, inlineCache->index);
+        printf("Cache hit for getting instance variable: '%s' from Shape ID %d at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), entry->id, entry->index);
 #endif  
-        return getGenericInstanceVariableByIndex(vm, object, inlineCache->index);
+        return getGenericInstanceVariableByIndex(vm, object, entry->index);
     }
 
 #ifdef DEBUG_TRACE_CACHE
@@ -408,16 +402,16 @@ static bool getGenericInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_
     return getGenericInstanceVariableByName(vm, object, name);
 }
 
-bool getInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+bool getInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte, InlineCache* inlineCache) {
     if (IS_INSTANCE(receiver)) {
         ObjInstance* instance = AS_INSTANCE(receiver);
         int shapeID = instance->obj.shapeID;
-        if (inlineCache->type == CACHE_IVAR && inlineCache->id == shapeID) {
+        InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_IVAR, shapeID);
+        if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-            printf("Cache hit for getting instance variable: '%s' from Shape ID %d at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), inlineCache->id, inlineCache->index);
+            printf("Cache hit for getting instance variable: '%s' from Shape ID %d at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), entry->id, entry->index);
 #endif 
-            Value value = instance->fields.values[inlineCache->index];
+            Value value = instance->fields.values[entry->index];
             pop(vm);
             push(vm, value);
             return true;
@@ -445,19 +439,20 @@ bool getInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte) {
     }
     else if (IS_CLASS(receiver)) {
         ObjClass* klass = AS_CLASS(receiver);
-        if (inlineCache->type == CACHE_CVAR && inlineCache->id == klass->behaviorID) {
+        InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_CVAR, klass->behaviorID);
+        if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-            printf("Cache hit for getting class variable: '%s' from Behavior ID %d at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), inlineCache->id, inlineCache->index);
+            printf("Cache hit for getting class variable: '%s' from Behavior ID %d at index %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), entry->id, entry->index);
 #endif 
 
-            Value value = klass->fields.values[inlineCache->index];
+            Value value = klass->fields.values[entry->index];
             pop(vm);
             push(vm, value);
             return true;
         }
 
 #ifdef DEBUG_TRACE_CACHE
-        printf("Cache miss for getting class variable: '%s' from Behavior ID %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), inlineCache->id);
+        printf("Cache miss for getting class variable: '%s' from Behavior ID %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), klass->behaviorID);
 #endif
 
         ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
@@ -491,7 +486,7 @@ bool getInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte) {
                 exit(70);
             }
 
-            loadModule(vm, filePath);
+            loadModule(vm, filePath, false);
             pop(vm);
             pop(vm);
             tableGet(&enclosing->values, name, &value);
@@ -500,7 +495,7 @@ bool getInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte) {
         }
     }
     else if (IS_OBJ(receiver)) {
-        return getGenericInstanceVariable(vm, AS_OBJ(receiver), chunk, byte);
+        return getGenericInstanceVariable(vm, AS_OBJ(receiver), chunk, byte, inlineCache);
     }
     else {
         if (IS_NIL(receiver)) runtimeError(vm, "Undefined field on nil.");
@@ -877,15 +872,15 @@ bool setGenericInstanceVariableByName(VM* vm, Obj* object, ObjString* name, Valu
     return false;
 }
 
-static bool setGenericInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_t byte, Value value) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+static bool setGenericInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value value) {
     int shapeID = object->shapeID;
 
-    if (inlineCache->type == CACHE_IVAR && inlineCache->id == shapeID) {
+    InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_IVAR, shapeID);
+    if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-        printf("Cache hit for setting instance variable: Shape ID %d at index %d.\n", inlineCache->id, inlineCache->index);
+        printf("Cache hit for setting instance variable: Shape ID %d at index %d.\n", entry->id, entry->index);
 #endif 
-        return setGenericInstanceVariableByIndex(vm, object, inlineCache->index, value);
+        return setGenericInstanceVariableByIndex(vm, object, entry->index, value);
     }
 
 #ifdef DEBUG_TRACE_CACHE
@@ -902,18 +897,29 @@ static bool setGenericInstanceVariable(VM* vm, Obj* object, Chunk* chunk, uint8_
     return setGenericInstanceVariableByName(vm, object, name, value);
 }
 
-bool setInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte, Value value) {
-    InlineCache* inlineCache = &chunk->inlineCaches[byte];
+bool setInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, Value value) {
     if (IS_INSTANCE(receiver)) {
         ObjInstance* instance = AS_INSTANCE(receiver);
         int shapeID = instance->obj.shapeID;
         PROCESS_WRITE_BARRIER((Obj*)instance, value);
 
-        if (inlineCache->type == CACHE_IVAR && inlineCache->id == shapeID) {
+        InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_IVAR, shapeID);
+        if (entry != NULL) {
+#ifdef DEBUG_TRACE_CACHE
+            printf("Cache hit for setting instance variable: Shape ID %d at index %d.\n", entry->id, entry->index);
+#endif 
+            instance->fields.values[entry->index] = value;
+            push(vm, value);
+            return true;
+        }
+
+        entry = getInlineCacheEntry(inlineCache, CACHE_TRANSITION, shapeID);
+        if (entry != NULL && entry->index == instance->fields.count) {
 #ifdef DEBUG_TRACE_CACHE
-            printf("Cache hit for setting instance variable: Shape ID %d at index %d.\n", inlineCache->id, inlineCache->index);
+            printf("Cache hit for shape transition: Shape ID %d to %d at index %d.\n", entry->id, entry->shapeID, entry->index);
 #endif 
-            instance->fields.values[inlineCache->index] = value;
+            instance->obj.shapeID = entry->shapeID;
+            valueArrayWrite(vm, &instance->fields, value);
             push(vm, value);
             return true;
         }
@@ -925,15 +931,17 @@ bool setInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte, Val
         ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
         IDMap* idMap = getShapeIndexes(vm, shapeID);
         int index;
-        if (idMapGet(idMap, name, &index)) instance->fields.values[index] = value;
+        if (idMapGet(idMap, name, &index)) {
+            instance->fields.values[index] = value;
+            writeInlineCache(inlineCache, CACHE_IVAR, shapeID, index);
+        }
         else {
             index = instance->fields.count;
             transitionShapeForObject(vm, &instance->obj, name);
             valueArrayWrite(vm, &instance->fields, value);
-            shapeID = instance->obj.shapeID;
+            writeTransitionCache(inlineCache, shapeID, instance->obj.shapeID, index);
         }
 
-        writeInlineCache(inlineCache, CACHE_IVAR, shapeID, index);
         push(vm, value);
         return true;
     }
@@ -941,12 +949,13 @@ bool setInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte, Val
         ObjClass* klass = AS_CLASS(receiver);
         PROCESS_WRITE_BARRIER((Obj*)klass, value);
 
-        if (inlineCache->type == CACHE_CVAR && inlineCache->id == klass->behaviorID) {
+        InlineCacheEntry* entry = getInlineCacheEntry(inlineCache, CACHE_CVAR, klass->behaviorID);
+        if (entry != NULL) {
 #ifdef DEBUG_TRACE_CACHE
-            printf("Cache hit for setting class variable: Behavior ID %d at index %d.\n", inlineCache->id, inlineCache->index);
+            printf("Cache hit for setting class variable: Behavior ID %d at index %d.\n", entry->id, entry->index);
 #endif 
 
-            klass->fields.values[inlineCache->index] = value;
+            klass->fields.values[entry->index] = value;
             push(vm, value);
             return true;
         }
@@ -988,7 +997,7 @@ bool setInstanceVariable(VM* vm, Value receiver, Chunk* chunk, uint8_t byte, Val
     }
     else if (IS_OBJ(receiver)) {
         PROCESS_WRITE_BARRIER(AS_OBJ(receiver), value);
-        return setGenericInstanceVariable(vm, AS_OBJ(receiver), chunk, byte, value);
+        return setGenericInstanceVariable(vm, AS_OBJ(receiver), chunk, byte, inlineCache, value);
     }
     else {
         runtimeError(vm, "Cannot set properties on %s.", valueToString(vm, value));
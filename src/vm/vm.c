@@ -29,11 +29,10 @@ static void resetCallFrame(VM* vm, int index) {
     frame->closure = NULL;
     frame->ip = NULL;
     frame->slots = NULL;
-    frame->handlerCount = 0;
 }
 
 static void resetCallFrames(VM* vm) {
-    for (int i = 0; i < FRAMES_MAX; i++) {
+    for (int i = 0; i < vm->frameCapacity; i++) {
         resetCallFrame(vm, i);
     }
 }
@@ -47,6 +46,69 @@ static void resetStack(VM* vm) {
     resetCallFrames(vm);
 }
 
+static void initStack(VM* vm) {
+    vm->frameCapacity = FRAMES_MIN;
+    vm->frames = (CallFrame*)malloc(sizeof(CallFrame) * vm->frameCapacity);
+    vm->stack = (Value*)malloc(sizeof(Value) * STACK_SIZE(vm->frameCapacity));
+    vm->retiredStacks = NULL;
+    if (vm->frames == NULL || vm->stack == NULL) exit(1);
+    resetStack(vm);
+}
+
+static void freeRetiredStacks(VM* vm) {
+    while (vm->retiredStacks != NULL) {
+        RetiredStack* retired = vm->retiredStacks;
+        vm->retiredStacks = retired->next;
+        free(retired->frames);
+        free(retired->stack);
+        free(retired);
+    }
+}
+
+static void freeStack(VM* vm) {
+    freeRetiredStacks(vm);
+    free(vm->frames);
+    free(vm->stack);
+    vm->frames = NULL;
+    vm->stack = NULL;
+    vm->stackTop = NULL;
+    vm->frameCapacity = 0;
+}
+
+static bool growStack(VM* vm) {
+    if (vm->frameCapacity >= vm->config.maxFrames) return false;
+    int oldCapacity = vm->frameCapacity;
+    int capacity = (oldCapacity * 2 < vm->config.maxFrames) ? oldCapacity * 2 : vm->config.maxFrames;
+
+    CallFrame* frames = (CallFrame*)malloc(sizeof(CallFrame) * capacity);
+    Value* stack = (Value*)malloc(sizeof(Value) * STACK_SIZE(capacity));
+    RetiredStack* retired = (RetiredStack*)malloc(sizeof(RetiredStack));
+    if (frames == NULL || stack == NULL || retired == NULL) exit(1);
+
+    memcpy(frames, vm->frames, sizeof(CallFrame) * oldCapacity);
+    memcpy(stack, vm->stack, sizeof(Value) * (vm->stackTop - vm->stack));
+    for (int i = 0; i < vm->frameCount; i++) {
+        frames[i].slots = stack + (vm->frames[i].slots - vm->stack);
+    }
+    for (ObjUpvalue* upvalue = vm->openUpvalues; upvalue != NULL; upvalue = upvalue->next) {
+        upvalue->location = stack + (upvalue->location - vm->stack);
+    }
+
+    retired->frames = vm->frames;
+    retired->stack = vm->stack;
+    retired->next = vm->retiredStacks;
+    vm->retiredStacks = retired;
+
+    vm->stackTop = stack + (vm->stackTop - vm->stack);
+    vm->frames = frames;
+    vm->stack = stack;
+    vm->frameCapacity = capacity;
+    for (int i = oldCapacity; i < capacity; i++) {
+        resetCallFrame(vm, i);
+    }
+    return true;
+}
+
 void runtimeError(VM* vm, const char* format, ...) {
     va_list args;
     va_start(args, format);
@@ -58,7 +120,7 @@ void runtimeError(VM* vm, const char* format, ...) {
         CallFrame* frame = &vm->frames[i];
         ObjFunction* function = frame->closure->function;
         size_t instruction = frame->ip - function->chunk.code - 1;
-        fprintf(stderr, "[line %d] in ", function->chunk.lines[instruction]);
+        fprintf(stderr, "[line %d] in ", getLine(&function->chunk, (int)instruction));
 
         if (function->name == NULL) {
             fprintf(stderr, "script\n");
@@ -129,6 +191,22 @@ static int parseConfiguration(void* data, const char* section, const char* name,
     else if (HAS_CONFIG("flag", "flagMutableVariable")) {
         config->flagMutableVariable = (uint8_t)atoi(value);
     }
+    else if (HAS_CONFIG("compiler", "optimizeAst")) {
+        config->optimizeAst = (bool)atoi(value);
+    }
+    else if (HAS_CONFIG("compiler", "cacheBytecode")) {
+        config->cacheBytecode = (bool)atoi(value);
+    }
+    else if (HAS_CONFIG("vm", "maxFrames")) {
+        int maxFrames = atoi(value);
+        config->maxFrames = (maxFrames < FRAMES_MIN) ? FRAMES_MAX : maxFrames;
+    }
+    else if (HAS_CONFIG("cache", "path")) {
+        config->cachePath = _strdup(value);
+    }
+    else if (HAS_CONFIG("cache", "maxSize")) {
+        config->cacheMaxSize = (size_t)atol(value);
+    }
     else if (HAS_CONFIG("gc", "gcType")) {
         config->gcType = _strdup(value);
     }
@@ -144,6 +222,12 @@ static int parseConfiguration(void* data, const char* section, const char* name,
     else if (HAS_CONFIG("gc", "gcOldHeapSize")) {
         config->gcOldHeapSize = (size_t)atol(value);
     }
+    else if (HAS_CONFIG("gc", "gcMaxPause")) {
+        config->gcMaxPause = atoi(value);
+    }
+    else if (HAS_CONFIG("gc", "gcWorkerCount")) {
+        config->gcWorkerCount = atoi(value);
+    }
     else {
         return 0;
     }
@@ -151,16 +235,46 @@ static int parseConfiguration(void* data, const char* section, const char* name,
 #undef HAS_CONFIG
 }
 
-static void initConfiguration(VM* vm) {
+static const char* operatorNames[OPERATOR_COUNT] = { "+", "-", "*", "/", "%", "==", ">", "<", "[]", "[]=", "..", "()" };
+
+static void initOperatorStrings(VM* vm) {
+    for (int i = 0; i < OPERATOR_COUNT; i++) {
+        vm->operatorStrings[i] = copyStringPerma(vm, operatorNames[i], (int)strlen(operatorNames[i]));
+    }
+}
+
+static void overrideConfiguration(Configuration* config, const char* option) {
+    char section[UINT8_MAX], name[UINT8_MAX];
+    const char* dot = strchr(option, '.');
+    const char* equal = strchr(option, '=');
+    ABORT_IFTRUE(dot == NULL || equal == NULL || dot > equal || equal - option >= UINT8_MAX,
+        "Invalid configuration option '%s', expect --section.name=value.\n", option);
+
+    snprintf(section, UINT8_MAX, "%.*s", (int)(dot - option), option);
+    snprintf(name, UINT8_MAX, "%.*s", (int)(equal - dot - 1), dot + 1);
+    ABORT_IFTRUE(!parseConfiguration(config, section, name, equal + 1), "Unknown configuration option '%s'.\n", option);
+}
+
+static void initConfiguration(VM* vm, int optionCount, char* options[]) {
     Configuration config;
+    config.cacheBytecode = false;
+    config.optimizeAst = false;
+    config.maxFrames = FRAMES_MAX;
+    config.cachePath = "";
+    config.cacheMaxSize = 67108864;
+    config.gcMaxPause = 0;
+    config.gcWorkerCount = 0;
     int iniParsed = ini_parse("lox2.ini", parseConfiguration, &config);
     ABORT_IFTRUE(iniParsed < 0, "Can't load 'lox2.ini' configuration file...\n");
+    for (int i = 0; i < optionCount; i++) {
+        overrideConfiguration(&config, options[i] + 2);
+    }
     vm->config = config;
 }
 
-void initVM(VM* vm) {
-    resetStack(vm);
-    initConfiguration(vm);
+void initVM(VM* vm, int optionCount, char* options[]) {
+    initConfiguration(vm, optionCount, options);
+    initStack(vm);
     vm->currentModule = NULL;
     vm->runningGenerator = NULL;
     vm->numSymtabs = 0;
@@ -189,6 +303,8 @@ void initVM(VM* vm) {
 
     vm->initString = copyStringPerma(vm, "__init__", 8);
     vm->voidString = copyStringPerma(vm, "void", 4);
+    initOperatorStrings(vm);
+    initInterceptorStrings(vm);
     typeTableSet(vm->typetab, vm->voidString, newTypeInfo(0, sizeof(TypeInfo), TYPE_CATEGORY_VOID, vm->voidString, vm->voidString));
 
     registerLangPackage(vm);
@@ -217,6 +333,7 @@ void freeVM(VM* vm) {
     freeObjects(vm);
     freeGC(vm);
     freeLoop(vm);
+    freeStack(vm);
 }
 
 void push(VM* vm, Value value) {
@@ -299,6 +416,100 @@ static void makeDictionary(VM* vm, uint8_t entryCount) {
     push(vm, OBJ_VAL(dictionary));
 }
 
+static int formatPrimitive(Value value, char* chars, size_t size) {
+    if (IS_INT(value)) return snprintf(chars, size, "%d", AS_INT(value));
+    else if (IS_FLOAT(value)) return snprintf(chars, size, "%g", AS_FLOAT(value));
+    else if (IS_BOOL(value)) return snprintf(chars, size, "%s", AS_BOOL(value) ? "true" : "false");
+    else if (IS_NIL(value)) return snprintf(chars, size, "nil");
+    return -1;
+}
+
+static bool interpolate(VM* vm, uint8_t count) {
+    Value* parts = vm->stackTop - count;
+    char primitives[UINT8_MAX][24];
+    int lengths[UINT8_MAX];
+    int length = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (IS_STRING(parts[i])) lengths[i] = AS_STRING(parts[i])->length;
+        else if ((lengths[i] = formatPrimitive(parts[i], primitives[i], sizeof(primitives[i]))) < 0) return false;
+        length += lengths[i];
+    }
+
+    char buffer[UINT8_MAX + 1];
+    char* chars = (length < (int)sizeof(buffer)) ? buffer : bufferNewCString(length);
+    char* current = chars;
+    for (int i = 0; i < count; i++) {
+        memcpy(current, IS_STRING(parts[i]) ? AS_STRING(parts[i])->chars : primitives[i], lengths[i]);
+        current += lengths[i];
+    }
+    *current = '\0';
+
+    ObjString* result = copyString(vm, chars, length);
+    if (chars != buffer) free(chars);
+    vm->stackTop -= count;
+    push(vm, OBJ_VAL(result));
+    return true;
+}
+
+static bool isNativeIterable(VM* vm, Value value) {
+    if (!IS_OBJ(value)) return false;
+    ObjClass* klass = AS_OBJ(value)->klass;
+    switch (AS_OBJ(value)->category) {
+        case OBJ_ARRAY: return klass == vm->arrayClass;
+        case OBJ_DICTIONARY: return klass == vm->dictionaryClass;
+        case OBJ_RANGE: return klass == vm->rangeClass;
+        case OBJ_STRING: return klass == vm->stringClass;
+        default: return false;
+    }
+}
+
+static bool iterateNative(VM* vm, Value* slots) {
+    Obj* iterable = AS_OBJ(slots[0]);
+    int position = AS_INT(slots[1]);
+    Value index, element;
+
+    switch (iterable->category) {
+        case OBJ_ARRAY: {
+            ObjArray* array = (ObjArray*)iterable;
+            if (position >= array->elements.count - 1) return false;
+            position++;
+            index = INT_VAL(position);
+            element = array->elements.values[position];
+            break;
+        }
+        case OBJ_DICTIONARY: {
+            ObjDictionary* dict = (ObjDictionary*)iterable;
+            do {
+                if (++position >= dict->capacity) return false;
+            } while (IS_UNDEFINED(dict->entries[position].key));
+            index = dict->entries[position].key;
+            element = dict->entries[position].value;
+            break;
+        }
+        case OBJ_RANGE: {
+            ObjRange* range = (ObjRange*)iterable;
+            if (position >= abs(range->to - range->from)) return false;
+            position++;
+            index = INT_VAL(position);
+            element = INT_VAL(range->from + ((range->from < range->to) ? position : -position));
+            break;
+        }
+        default: {
+            ObjString* string = (ObjString*)iterable;
+            if (position >= string->length - 1) return false;
+            position += utf8CodePointOffset(vm, string->chars, position);
+            index = INT_VAL(position);
+            element = OBJ_VAL(utf8CodePointAtIndex(vm, string->chars, position));
+        }
+    }
+
+    slots[1] = INT_VAL(position);
+    slots[2] = index;
+    push(vm, element);
+    return true;
+}
+
 static ObjArray* makeTraitArray(VM* vm, uint8_t behaviorCount) {
     ObjArray* traits = newArray(vm);
     push(vm, OBJ_VAL(traits));
@@ -349,12 +560,12 @@ static bool callClosureAsync(VM* vm, ObjClosure* closure, int argCount) {
 bool callClosure(VM* vm, ObjClosure* closure, int argCount) {
     if (closure->function->arity > 0 && argCount != closure->function->arity) {
         throwNativeException(vm, "clox.std.lang.IllegalArgumentException", "Expected %d argument but got %d.", closure->function->arity, argCount);
-        return false;
+        return true;
     }
 
-    if (vm->frameCount == FRAMES_MAX) {
+    if (vm->frameCount == vm->frameCapacity && !growStack(vm)) {
         throwNativeException(vm, "clox.std.lang.StackOverflowException", "Stack overflow.");
-        return false;
+        return true;
     }
 
     if (closure->function->arity == -1) {
@@ -456,6 +667,11 @@ Value callReentrantMethod(VM* vm, Value receiver, Value callee, ...) {
 Value callGenerator(VM* vm, ObjGenerator* generator) {
     ObjGenerator* outer = vm->runningGenerator;
     vm->runningGenerator = generator;
+    if (vm->frameCount == vm->frameCapacity && !growStack(vm)) {
+        vm->runningGenerator = outer;
+        throwNativeException(vm, "clox.std.lang.StackOverflowException", "Stack overflow.");
+        return NIL_VAL;
+    }
     loadGeneratorFrame(vm, generator);
     InterpretResult result = run(vm);
     if (result == INTERPRET_RUNTIME_ERROR) exit(70);
@@ -469,6 +685,27 @@ Value callGenerator(VM* vm, ObjGenerator* generator) {
     return pop(vm);
 }
 
+static bool invokeOperator(VM* vm, OperatorType type, int arity) {
+    ObjClass* klass = getObjClass(vm, peek(vm, arity));
+    if (klass->operatorVersion != klass->methodVersion) {
+        for (int i = 0; i < OPERATOR_COUNT; i++) {
+            klass->operators[i] = NIL_VAL;
+        }
+        klass->operatorVersion = klass->methodVersion;
+    }
+
+    Value method = klass->operators[type];
+    if (IS_NIL(method)) {
+        ObjString* op = vm->operatorStrings[type];
+        if (!tableGet(&klass->methods, op, &method)) {
+            throwNativeException(vm, "clox.std.lang.MethodNotFoundException", "Undefined operator method '%s' on class %s.", op->chars, klass->fullName->chars);
+            return true;
+        }
+        klass->operators[type] = method;
+    }
+    return callMethod(vm, method, arity);
+}
+
 static bool callValue(VM* vm, Value callee, int argCount) {
     if (IS_OBJ(callee)) {
         switch (OBJ_CATEGORY(callee)) {
@@ -481,14 +718,7 @@ static bool callValue(VM* vm, Value callee, int argCount) {
         }
     }
 
-    ObjClass* klass = getObjClass(vm, callee);
-    ObjString* name = copyStringPerma(vm, "()", 2);
-    Value method;
-    if (!tableGet(&klass->methods, name, &method)) { 
-        throwNativeException(vm, "clox.std.lang.MethodNotFoundException", "Undefined operator method '%s' on class %s.", name->chars, klass->fullName->chars);
-        return false;
-    }
-    return callMethod(vm, method, argCount);
+    return invokeOperator(vm, OPERATOR_CALL, argCount);
 }
 
 static bool invokeFromClass(VM* vm, ObjClass* klass, ObjString* name, int argCount) {
@@ -531,18 +761,58 @@ static bool invoke(VM* vm, ObjString* name, int argCount) {
     return invokeFromClass(vm, getObjClass(vm, receiver), name, argCount);
 }
 
-static bool invokeOperator(VM* vm, ObjString* op, int arity) {
-    Value receiver = peek(vm, arity);
+static bool invokeFromCache(VM* vm, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, int argCount) {
+    Value receiver = peek(vm, argCount);
     ObjClass* klass = getObjClass(vm, receiver);
+    int shapeID = IS_INSTANCE(receiver) ? AS_OBJ(receiver)->shapeID : -1;
+
+    InlineCacheEntry* entry = getMethodCacheEntry(inlineCache, klass->behaviorID, shapeID, klass->methodVersion);
+    if (entry != NULL) {
+#ifdef DEBUG_TRACE_CACHE
+        printf("Cache hit for invoking method: '%s' from Behavior ID %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), klass->behaviorID);
+#endif
+        return callMethod(vm, entry->method, argCount);
+    }
+
+#ifdef DEBUG_TRACE_CACHE
+    printf("Cache miss for invoking method: '%s' from Behavior ID %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), klass->behaviorID);
+#endif
+
+    ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
+    if (IS_NAMESPACE(receiver)) return invoke(vm, name, argCount);
+    else if (IS_INSTANCE(receiver)) {
+        IDMap* idMap = getShapeIndexes(vm, shapeID);
+        int index;
+        if (idMapGet(idMap, name, &index)) return invoke(vm, name, argCount);
+    }
+
     Value method;
-    
-    if (!tableGet(&klass->methods, op, &method)) {
-        throwNativeException(vm, "clox.std.lang.MethodNotFoundException", "Undefined operator method '%s' on class %s.", op->chars, klass->fullName->chars);
-        return false;
+    if (!tableGet(&klass->methods, name, &method)) return invokeFromClass(vm, klass, name, argCount);
+    writeMethodCache(inlineCache, klass->behaviorID, shapeID, klass->methodVersion, method);
+    return callMethod(vm, method, argCount);
+}
+
+static bool invokeSuperFromCache(VM* vm, ObjClass* klass, Chunk* chunk, uint8_t byte, InlineCache* inlineCache, int argCount) {
+    InlineCacheEntry* entry = getMethodCacheEntry(inlineCache, klass->behaviorID, -1, klass->methodVersion);
+    if (entry != NULL) {
+#ifdef DEBUG_TRACE_CACHE
+        printf("Cache hit for invoking super method: '%s' from Behavior ID %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), klass->behaviorID);
+#endif
+        return callMethod(vm, entry->method, argCount);
     }
-    return invoke(vm, op, arity);
+
+#ifdef DEBUG_TRACE_CACHE
+    printf("Cache miss for invoking super method: '%s' from Behavior ID %d.\n", AS_CSTRING(chunk->identifiers.values[byte]), klass->behaviorID);
+#endif
+
+    ObjString* name = AS_STRING(chunk->identifiers.values[byte]);
+    Value method;
+    if (!tableGet(&klass->methods, name, &method)) return invokeFromClass(vm, klass, name, argCount);
+    writeMethodCache(inlineCache, klass->behaviorID, -1, klass->methodVersion, method);
+    return callMethod(vm, method, argCount);
 }
 
+
 static bool hasMethod(VM* vm, ObjClass* klass, ObjString* name) { 
     if (name == NULL) return false;
     Value method;
@@ -597,6 +867,8 @@ static void defineMethod(VM* vm, ObjString* name, bool isClassMethod) {
     }
 
     tableSet(vm, &klass->methods, name, method);
+    PROCESS_WRITE_BARRIER((Obj*)klass, method);
+    klass->methodVersion++;
     handleInterceptorMethod(vm, klass, name);
     pop(vm);
 }
@@ -627,27 +899,187 @@ static ObjUpvalue* captureUpvalue(VM* vm, Value* local) {
 static void closeUpvalues(VM* vm, Value* last) {
     while (vm->openUpvalues != NULL && vm->openUpvalues->location >= last) {
         ObjUpvalue* upvalue = vm->openUpvalues;
+        PROCESS_WRITE_BARRIER((Obj*)upvalue, *upvalue->location);
         upvalue->closed = *upvalue->location;
         upvalue->location = &upvalue->closed;
         vm->openUpvalues = upvalue->next;
     }
 }
 
+static bool hasActiveHandler(Chunk* chunk, int offset) {
+    for (int i = 0; i < chunk->handlerCount; i++) {
+        ExceptionHandler* handler = &chunk->handlers[i];
+        if (offset >= handler->startAddress && offset < handler->endAddress) return true;
+    }
+    return false;
+}
+
+static bool canReuseFrame(CallFrame* frame, int offset, ObjClosure* closure, int argCount) {
+    ObjFunction* caller = frame->closure->function;
+    ObjFunction* callee = closure->function;
+    return !hasActiveHandler(&caller->chunk, offset) && !caller->isGenerator && !caller->isAsync
+        && !callee->isGenerator && !callee->isAsync && callee->arity == argCount
+        && !HAS_OBJ_INTERCEPTOR(frame->slots[0], INTERCEPTOR_ON_RETURN);
+}
+
+static void reuseCallFrame(VM* vm, CallFrame* frame, ObjClosure* closure, int argCount) {
+    closeUpvalues(vm, frame->slots);
+    memmove(frame->slots, vm->stackTop - argCount - 1, sizeof(Value) * ((size_t)argCount + 1));
+    vm->stackTop = frame->slots + argCount + 1;
+    frame->closure = closure;
+    frame->ip = closure->function->chunk.code;
+}
+
+#ifdef DEBUG_TRACE_EXECUTION
+static void traceExecution(VM* vm, Chunk* chunk, uint8_t* ip) {
+    printf("          ");
+    for (Value* slot = vm->stack; slot < vm->stackTop; slot++) {
+        printf("[ ");
+        printValue(*slot);
+        printf(" ]");
+    }
+    printf("\n");
+    disassembleInstruction(chunk, (int)(ip - chunk->code));
+}
+#endif
+
 InterpretResult run(VM* vm) {
-    CallFrame* frame = &vm->frames[vm->frameCount - 1];
+    CallFrame* frame;
+    Chunk* chunk;
+    uint8_t* ip;
+    Value* constants;
+    Value* identifiers;
 
-#define LOAD_FRAME() (frame = &vm->frames[vm->frameCount - 1])
-#define READ_BYTE() (*frame->ip++)
-#define READ_SHORT() (frame->ip += 2, (uint16_t)((frame->ip[-2] << 8) | frame->ip[-1]))
-#define READ_CONSTANT() (frame->closure->function->chunk.constants.values[READ_BYTE()])
-#define READ_IDENTIFIER() (frame->closure->function->chunk.identifiers.values[READ_BYTE()])
+#define LOAD_FRAME() \
+    do { \
+        frame = &vm->frames[vm->frameCount - 1]; \
+        chunk = &frame->closure->function->chunk; \
+        ip = frame->ip; \
+        constants = chunk->constants.values; \
+        identifiers = chunk->identifiers.values; \
+    } while (false)
+
+#define STORE_FRAME() (frame->ip = ip)
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, (uint16_t)((ip[-2] << 8) | ip[-1]))
+#define READ_CONSTANT() (constants[READ_BYTE()])
+#define READ_IDENTIFIER() (identifiers[READ_BYTE()])
 #define READ_STRING() AS_STRING(READ_IDENTIFIER())
+#define READ_INLINE_CACHE() (&chunk->inlineCaches[READ_SHORT()])
+
+#ifdef DEBUG_TRACE_EXECUTION
+#define TRACE_EXECUTION() traceExecution(vm, chunk, ip)
+#else
+#define TRACE_EXECUTION() ((void)0)
+#endif
+
+#ifdef COMPUTED_GOTO
+    static void* dispatchTable[] = {
+        [OP_CONSTANT] = &&DO_OP_CONSTANT,
+        [OP_NIL] = &&DO_OP_NIL,
+        [OP_TRUE] = &&DO_OP_TRUE,
+        [OP_FALSE] = &&DO_OP_FALSE,
+        [OP_POP] = &&DO_OP_POP,
+        [OP_DUP] = &&DO_OP_DUP,
+        [OP_GET_LOCAL] = &&DO_OP_GET_LOCAL,
+        [OP_SET_LOCAL] = &&DO_OP_SET_LOCAL,
+        [OP_DEFINE_GLOBAL_VAL] = &&DO_OP_DEFINE_GLOBAL_VAL,
+        [OP_DEFINE_GLOBAL_VAR] = &&DO_OP_DEFINE_GLOBAL_VAR,
+        [OP_GET_GLOBAL] = &&DO_OP_GET_GLOBAL,
+        [OP_SET_GLOBAL] = &&DO_OP_SET_GLOBAL,
+        [OP_GET_UPVALUE] = &&DO_OP_GET_UPVALUE,
+        [OP_SET_UPVALUE] = &&DO_OP_SET_UPVALUE,
+        [OP_GET_PROPERTY] = &&DO_OP_GET_PROPERTY,
+        [OP_SET_PROPERTY] = &&DO_OP_SET_PROPERTY,
+        [OP_GET_PROPERTY_OPTIONAL] = &&DO_OP_GET_PROPERTY_OPTIONAL,
+        [OP_GET_SUBSCRIPT] = &&DO_OP_GET_SUBSCRIPT,
+        [OP_SET_SUBSCRIPT] = &&DO_OP_SET_SUBSCRIPT,
+        [OP_GET_SUBSCRIPT_OPTIONAL] = &&DO_OP_GET_SUBSCRIPT_OPTIONAL,
+        [OP_GET_SUPER] = &&DO_OP_GET_SUPER,
+        [OP_EQUAL] = &&DO_OP_EQUAL,
+        [OP_GREATER] = &&DO_OP_GREATER,
+        [OP_LESS] = &&DO_OP_LESS,
+        [OP_ADD] = &&DO_OP_ADD,
+        [OP_SUBTRACT] = &&DO_OP_SUBTRACT,
+        [OP_MULTIPLY] = &&DO_OP_MULTIPLY,
+        [OP_DIVIDE] = &&DO_OP_DIVIDE,
+        [OP_MODULO] = &&DO_OP_MODULO,
+        [OP_NIL_COALESCING] = &&DO_OP_NIL_COALESCING,
+        [OP_ELVIS] = &&DO_OP_ELVIS,
+        [OP_NOT] = &&DO_OP_NOT,
+        [OP_NEGATE] = &&DO_OP_NEGATE,
+        [OP_JUMP] = &&DO_OP_JUMP,
+        [OP_JUMP_IF_FALSE] = &&DO_OP_JUMP_IF_FALSE,
+        [OP_LOOP] = &&DO_OP_LOOP,
+        [OP_CALL] = &&DO_OP_CALL,
+        [OP_OPTIONAL_CALL] = &&DO_OP_OPTIONAL_CALL,
+        [OP_INVOKE] = &&DO_OP_INVOKE,
+        [OP_SUPER_INVOKE] = &&DO_OP_SUPER_INVOKE,
+        [OP_OPTIONAL_INVOKE] = &&DO_OP_OPTIONAL_INVOKE,
+        [OP_CLOSURE] = &&DO_OP_CLOSURE,
+        [OP_CLOSE_UPVALUE] = &&DO_OP_CLOSE_UPVALUE,
+        [OP_CLASS] = &&DO_OP_CLASS,
+        [OP_TRAIT] = &&DO_OP_TRAIT,
+        [OP_ANONYMOUS] = &&DO_OP_ANONYMOUS,
+        [OP_INHERIT] = &&DO_OP_INHERIT,
+        [OP_IMPLEMENT] = &&DO_OP_IMPLEMENT,
+        [OP_FIELD] = &&DO_OP_FIELD,
+        [OP_METHOD] = &&DO_OP_METHOD,
+        [OP_TYPE] = &&DO_OP_TYPE,
+        [OP_ARRAY] = &&DO_OP_ARRAY,
+        [OP_DICTIONARY] = &&DO_OP_DICTIONARY,
+        [OP_RANGE] = &&DO_OP_RANGE,
+        [OP_REQUIRE] = &&DO_OP_REQUIRE,
+        [OP_NAMESPACE] = &&DO_OP_NAMESPACE,
+        [OP_DECLARE_NAMESPACE] = &&DO_OP_DECLARE_NAMESPACE,
+        [OP_GET_NAMESPACE] = &&DO_OP_GET_NAMESPACE,
+        [OP_USING_NAMESPACE] = &&DO_OP_USING_NAMESPACE,
+        [OP_THROW] = &&DO_OP_THROW,
+        [OP_FINALLY] = &&DO_OP_FINALLY,
+        [OP_RETURN] = &&DO_OP_RETURN,
+        [OP_RETURN_NONLOCAL] = &&DO_OP_RETURN_NONLOCAL,
+        [OP_YIELD] = &&DO_OP_YIELD,
+        [OP_YIELD_FROM] = &&DO_OP_YIELD_FROM,
+        [OP_AWAIT] = &&DO_OP_AWAIT,
+        [OP_ADD_INT] = &&DO_OP_ADD_INT,
+        [OP_ADD_FLOAT] = &&DO_OP_ADD_FLOAT,
+        [OP_ADD_STRING] = &&DO_OP_ADD_STRING,
+        [OP_SUBTRACT_INT] = &&DO_OP_SUBTRACT_INT,
+        [OP_SUBTRACT_FLOAT] = &&DO_OP_SUBTRACT_FLOAT,
+        [OP_GREATER_INT] = &&DO_OP_GREATER_INT,
+        [OP_GREATER_FLOAT] = &&DO_OP_GREATER_FLOAT,
+        [OP_LESS_INT] = &&DO_OP_LESS_INT,
+        [OP_LESS_FLOAT] = &&DO_OP_LESS_FLOAT,
+        [OP_EQUAL_INT] = &&DO_OP_EQUAL_INT,
+        [OP_GET_SUBSCRIPT_ARRAY_INT] = &&DO_OP_GET_SUBSCRIPT_ARRAY_INT,
+        [OP_GET_LOCAL_LOCAL] = &&DO_OP_GET_LOCAL_LOCAL,
+        [OP_GET_LOCAL_PROPERTY] = &&DO_OP_GET_LOCAL_PROPERTY,
+        [OP_POP_JUMP_IF_FALSE] = &&DO_OP_POP_JUMP_IF_FALSE,
+        [OP_FOR_PREP] = &&DO_OP_FOR_PREP,
+        [OP_FOR_ITER] = &&DO_OP_FOR_ITER,
+        [OP_TO_STRING] = &&DO_OP_TO_STRING,
+        [OP_INTERPOLATE] = &&DO_OP_INTERPOLATE,
+        [OP_TAIL_CALL] = &&DO_OP_TAIL_CALL
+    };
+
+#define DISPATCH(instruction) goto *dispatchTable[instruction = READ_BYTE()];
+#define CASE(opcode) DO_##opcode
+#define NEXT \
+    do { \
+        TRACE_EXECUTION(); \
+        goto *dispatchTable[READ_BYTE()]; \
+    } while (false)
+#else
+#define DISPATCH(instruction) switch (instruction = READ_BYTE())
+#define CASE(opcode) case opcode
+#define NEXT break
+#endif
 
 #define BINARY_INT_OP(valueType, op) \
     do { \
         int b = AS_INT(pop(vm)); \
         int a = AS_INT(pop(vm)); \
-        push(vm, INT_VAL(a op b)); \
+        push(vm, valueType(a op b)); \
     } while (false)
 
 #define BINARY_NUMBER_OP(valueType, op) \
@@ -657,56 +1089,78 @@ InterpretResult run(VM* vm) {
         push(vm, valueType(a op b)); \
     } while (false)
 
+#define BINARY_FLOAT_OP(valueType, op) \
+    do { \
+        double b = AS_FLOAT(pop(vm)); \
+        double a = AS_FLOAT(pop(vm)); \
+        push(vm, valueType(a op b)); \
+    } while (false)
+
+#define SITE_OFFSET() ((int)(ip - chunk->code - 1))
+#define QUICKEN(opcode) \
+    do { \
+        if (!isSiteDeoptimized(chunk, SITE_OFFSET())) ip[-1] = opcode; \
+    } while (false)
+#define DEQUICKEN(opcode) (markSiteDeoptimized(vm, chunk, SITE_OFFSET()), ip[-1] = opcode, ip--)
+#define BOTH_INT() (IS_INT(peek(vm, 0)) && IS_INT(peek(vm, 1)))
+#define BOTH_FLOAT() (IS_FLOAT(peek(vm, 0)) && IS_FLOAT(peek(vm, 1)))
+
 
-#define CAN_INTERCEPT(receiver, interceptorType, interceptorName) \
-    HAS_OBJ_INTERCEPTOR(receiver, interceptorType) && !matchVariableName(frame->closure->function->name, #interceptorName, (int)strlen(#interceptorName))
+#define CAN_INTERCEPT(receiver, interceptorType) \
+    (HAS_OBJ_INTERCEPTOR(receiver, interceptorType) && frame->closure->function->interceptor != interceptorType)
 
-#define OVERLOAD_OP(op, arity) \
+#define OVERLOAD_OP(type, arity) \
     do { \
-        ObjString* opName = newStringPerma(vm, #op); \
-        if (!invokeOperator(vm, opName, arity)) { \
+        STORE_FRAME(); \
+        if (!invokeOperator(vm, type, arity)) { \
             return INTERPRET_RUNTIME_ERROR; \
         } \
         LOAD_FRAME(); \
     } while (false)
 
+#define THROW_NATIVE_EXCEPTION(exceptionClassName, ...) \
+    do { \
+        STORE_FRAME(); \
+        throwNativeException(vm, exceptionClassName, ##__VA_ARGS__); \
+        LOAD_FRAME(); \
+    } while (false)
+
 #define RUNTIME_ERROR(...) \
     do { \
+        STORE_FRAME(); \
         runtimeError(vm, ##__VA_ARGS__); \
         return INTERPRET_RUNTIME_ERROR; \
     }  while (false)
 
+    LOAD_FRAME();
     for (;;) {
-#ifdef DEBUG_TRACE_EXECUTION
-        printf("          ");
-        for (Value* slot = vm->stack; slot < vm->stackTop; slot++) {
-            printf("[ ");
-            printValue(*slot);
-            printf(" ]");
-        }
-        printf("\n");
-        disassembleInstruction(&frame->closure->function->chunk, (int)(frame->ip - frame->closure->function->chunk.code));
-#endif
-
+        TRACE_EXECUTION();
         uint8_t instruction;
-        switch (instruction = READ_BYTE()) {
-            case OP_CONSTANT: push(vm, READ_CONSTANT()); break;
-            case OP_NIL: push(vm, NIL_VAL); break;
-            case OP_TRUE: push(vm, BOOL_VAL(true)); break;
-            case OP_FALSE: push(vm, BOOL_VAL(false)); break;
-            case OP_POP: pop(vm); break;
-            case OP_DUP: push(vm, peek(vm, 0)); break;
-            case OP_GET_LOCAL: {
+        DISPATCH(instruction) {
+            CASE(OP_CONSTANT): push(vm, READ_CONSTANT()); NEXT;
+            CASE(OP_NIL): push(vm, NIL_VAL); NEXT;
+            CASE(OP_TRUE): push(vm, BOOL_VAL(true)); NEXT;
+            CASE(OP_FALSE): push(vm, BOOL_VAL(false)); NEXT;
+            CASE(OP_POP): pop(vm); NEXT;
+            CASE(OP_DUP): push(vm, peek(vm, 0)); NEXT;
+            CASE(OP_GET_LOCAL): {
+                uint8_t slot = READ_BYTE();
+                push(vm, frame->slots[slot]);
+                NEXT;
+            }
+            CASE(OP_GET_LOCAL_LOCAL): {
                 uint8_t slot = READ_BYTE();
+                uint8_t slot2 = READ_BYTE();
                 push(vm, frame->slots[slot]);
-                break;
+                push(vm, frame->slots[slot2]);
+                NEXT;
             }
-            case OP_SET_LOCAL: {
+            CASE(OP_SET_LOCAL): {
                 uint8_t slot = READ_BYTE();
                 frame->slots[slot] = peek(vm, 0);
-                break;
+                NEXT;
             }
-            case OP_DEFINE_GLOBAL_VAL: {
+            CASE(OP_DEFINE_GLOBAL_VAL): {
                 ObjString* name = READ_STRING();
                 Value value = peek(vm, 0);
                 int index;
@@ -718,9 +1172,9 @@ InterpretResult run(VM* vm) {
                     valueArrayWrite(vm, &vm->currentModule->valFields, value);
                 }
                 pop(vm);
-                break;
+                NEXT;
             }
-            case OP_DEFINE_GLOBAL_VAR: {
+            CASE(OP_DEFINE_GLOBAL_VAR): {
                 ObjString* name = READ_STRING();
                 Value value = peek(vm, 0);
                 int index;
@@ -732,87 +1186,98 @@ InterpretResult run(VM* vm) {
                     valueArrayWrite(vm, &vm->currentModule->varFields, value);
                 }
                 pop(vm);
-                break;
+                NEXT;
             }
-            case OP_GET_GLOBAL: {
+            CASE(OP_GET_GLOBAL): {
                 uint8_t byte = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
                 Value value;
-                if (!loadGlobal(vm, &frame->closure->function->chunk, byte, &value)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                if (!loadGlobal(vm, chunk, byte, inlineCache, &value)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     RUNTIME_ERROR("Undefined variable '%s'.", name->chars);
                 }
                 push(vm, value);
-                break;
+                NEXT;
             }
-            case OP_SET_GLOBAL: {
+            CASE(OP_SET_GLOBAL): {
                 ObjString* name = READ_STRING();
                 Value value = peek(vm, 0);
                 int index;
                 if (idMapGet(&vm->currentModule->varIndexes, name, &index)) vm->currentModule->varFields.values[index] = value;
                 else RUNTIME_ERROR("Undefined variable '%s'.", name->chars);
-                break;
+                NEXT;
             }
-            case OP_GET_UPVALUE: {
+            CASE(OP_GET_UPVALUE): {
                 uint8_t slot = READ_BYTE();
                 push(vm, *frame->closure->upvalues[slot]->location);
-                break;
+                NEXT;
             }
-            case OP_SET_UPVALUE: {
-                uint8_t slot = READ_BYTE();
-                *frame->closure->upvalues[slot]->location = peek(vm, 0);
-                break;
+            CASE(OP_SET_UPVALUE): {
+                ObjUpvalue* upvalue = frame->closure->upvalues[READ_BYTE()];
+                PROCESS_WRITE_BARRIER((Obj*)upvalue, peek(vm, 0));
+                *upvalue->location = peek(vm, 0);
+                NEXT;
             }
-            case OP_GET_PROPERTY: {
+            CASE(OP_GET_LOCAL_PROPERTY):
+                push(vm, frame->slots[READ_BYTE()]);
+                // falls through
+            CASE(OP_GET_PROPERTY): {
                 Value receiver = peek(vm, 0);
                 uint8_t byte = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
+                STORE_FRAME();
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_BEFORE_GET, __beforeGet__) && hasInstanceVariable(vm, AS_OBJ(receiver), &frame->closure->function->chunk, byte)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_BEFORE_GET) && hasInstanceVariable(vm, AS_OBJ(receiver), chunk, byte)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     interceptBeforeGet(vm, receiver, name);
                     LOAD_FRAME();
                 }
 
-                if (!getInstanceVariable(vm, receiver, &frame->closure->function->chunk, byte)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                if (!getInstanceVariable(vm, receiver, chunk, byte, inlineCache)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     if (interceptUndefinedGet(vm, receiver, name)) LOAD_FRAME();
                     else RUNTIME_ERROR("Undefined field '%s'", name->chars);
                 }
-                else if (CAN_INTERCEPT(receiver, INTERCEPTOR_AFTER_GET, __afterGet__)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                else if (CAN_INTERCEPT(receiver, INTERCEPTOR_AFTER_GET)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     Value value = pop(vm);
                     interceptAfterGet(vm, receiver, name, value);
                     LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_SET_PROPERTY: {
+            CASE(OP_SET_PROPERTY): {
                 Value value = pop(vm);
                 Value receiver = pop(vm);
                 uint8_t byte = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
+                STORE_FRAME();
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_BEFORE_SET, __beforeSet__) && hasInstanceVariable(vm, AS_OBJ(receiver), &frame->closure->function->chunk, byte)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_BEFORE_SET) && hasInstanceVariable(vm, AS_OBJ(receiver), chunk, byte)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     interceptBeforeSet(vm, receiver, name, value);
                     value = pop(vm);
                     LOAD_FRAME();
                 }
 
-                if (!setInstanceVariable(vm, receiver, &frame->closure->function->chunk, byte, value)) {
+                if (!setInstanceVariable(vm, receiver, chunk, byte, inlineCache, value)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                else if (CAN_INTERCEPT(receiver, INTERCEPTOR_AFTER_GET, __afterSet__)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                else if (CAN_INTERCEPT(receiver, INTERCEPTOR_AFTER_SET)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     interceptAfterSet(vm, receiver, name);
                     LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_GET_PROPERTY_OPTIONAL: {
+            CASE(OP_GET_PROPERTY_OPTIONAL): {
                 Value receiver = peek(vm, 0);
                 uint8_t byte = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
+                STORE_FRAME();
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_BEFORE_GET, __beforeGet__) && hasInstanceVariable(vm, AS_OBJ(receiver), &frame->closure->function->chunk, byte)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_BEFORE_GET) && hasInstanceVariable(vm, AS_OBJ(receiver), chunk, byte)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     interceptBeforeGet(vm, receiver, name);
                     LOAD_FRAME();
                 }
@@ -821,27 +1286,38 @@ InterpretResult run(VM* vm) {
                     pop(vm);
                     push(vm, NIL_VAL);
                 }
-                else if (!getInstanceVariable(vm, receiver, &frame->closure->function->chunk, byte)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                else if (!getInstanceVariable(vm, receiver, chunk, byte, inlineCache)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     if (interceptUndefinedGet(vm, receiver, name)) LOAD_FRAME();
                     else return INTERPRET_RUNTIME_ERROR;
                 }
-                else if (CAN_INTERCEPT(receiver, INTERCEPTOR_AFTER_GET, __afterGet__)) {
-                    ObjString* name = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
+                else if (CAN_INTERCEPT(receiver, INTERCEPTOR_AFTER_GET)) {
+                    ObjString* name = AS_STRING(identifiers[byte]);
                     Value value = pop(vm);
                     interceptAfterGet(vm, receiver, name, value);
                     LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_GET_SUBSCRIPT: {
+            CASE(OP_GET_SUBSCRIPT): {
+                if (IS_INT(peek(vm, 0)) && IS_ARRAY(peek(vm, 1))) {
+                    int index = AS_INT(peek(vm, 0));
+                    ObjArray* array = AS_ARRAY(peek(vm, 1));
+                    if (index >= 0 && index < array->elements.count) {
+                        QUICKEN(OP_GET_SUBSCRIPT_ARRAY_INT);
+                        vm->stackTop -= 2;
+                        push(vm, array->elements.values[index]);
+                        NEXT;
+                    }
+                }
+
                 if (IS_INT(peek(vm, 0))) {
                     int index = AS_INT(peek(vm, 0));
                     if (IS_STRING(peek(vm, 0))) {
                         pop(vm);
                         ObjString* string = AS_STRING(pop(vm));
                         if (index < 0 || index > string->length) {
-                            throwNativeException(vm, "clox.std.lang.IndexOutOfBoundsException", "String index is out of bound: %d.", index);
+                            THROW_NATIVE_EXCEPTION("clox.std.lang.IndexOutOfBoundsException", "String index is out of bound: %d.", index);
                         }
                         else {
                             char chars[2] = { string->chars[index], '\0' };
@@ -853,14 +1329,14 @@ InterpretResult run(VM* vm) {
                         pop(vm);
                         ObjArray* array = AS_ARRAY(pop(vm));
                         if (index < 0 || index > array->elements.count) {
-                            throwNativeException(vm, "clox.std.lang.IndexOutOfBoundsException", "Array index is out of bound: %d.", index);
+                            THROW_NATIVE_EXCEPTION("clox.std.lang.IndexOutOfBoundsException", "Array index is out of bound: %d.", index);
                         }
                         else {
                             Value element = array->elements.values[index];
                             push(vm, element);
                         }
                     }
-                    else OVERLOAD_OP([], 1);
+                    else OVERLOAD_OP(OPERATOR_GET_SUBSCRIPT, 1);
                 }
                 else if (IS_DICTIONARY(peek(vm, 1))) {
                     Value key = pop(vm);
@@ -869,31 +1345,29 @@ InterpretResult run(VM* vm) {
                     if (dictGet(dictionary, key, &value)) push(vm, value);
                     else push(vm, NIL_VAL);
                 }
-                else OVERLOAD_OP([], 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_GET_SUBSCRIPT, 1);
+                NEXT;
             }
-            case OP_SET_SUBSCRIPT: {
+            CASE(OP_SET_SUBSCRIPT): {
                 if (IS_INT(peek(vm, 1)) && IS_ARRAY(peek(vm, 2))) {
-                    Value element = pop(vm);
-                    int index = AS_INT(pop(vm));
-                    ObjArray* array = AS_ARRAY(pop(vm));
+                    Value element = peek(vm, 0);
+                    int index = AS_INT(peek(vm, 1));
+                    ObjArray* array = AS_ARRAY(peek(vm, 2));
                     PROCESS_WRITE_BARRIER((Obj*)array, element);
                     valueArrayPut(vm, &array->elements, index, element);
-                    push(vm, OBJ_VAL(array));
+                    pops(vm, 2);
                 }
                 else if (IS_DICTIONARY(peek(vm, 2))) {
-                    Value value = pop(vm);
-                    Value key = pop(vm);
-                    ObjDictionary* dictionary = AS_DICTIONARY(pop(vm));
-                    PROCESS_WRITE_BARRIER((Obj*)dictionary, key);
-                    PROCESS_WRITE_BARRIER((Obj*)dictionary, value);
+                    Value value = peek(vm, 0);
+                    Value key = peek(vm, 1);
+                    ObjDictionary* dictionary = AS_DICTIONARY(peek(vm, 2));
                     dictSet(vm, dictionary, key, value);
-                    push(vm, OBJ_VAL(dictionary));
+                    pops(vm, 2);
                 }
-                else OVERLOAD_OP([]=, 2);
-                break;
+                else OVERLOAD_OP(OPERATOR_SET_SUBSCRIPT, 2);
+                NEXT;
             }
-            case OP_GET_SUBSCRIPT_OPTIONAL: {
+            CASE(OP_GET_SUBSCRIPT_OPTIONAL): {
                 if (IS_NIL(peek(vm, 1))) {
                     pops(vm, 2);
                     push(vm, NIL_VAL);
@@ -904,7 +1378,7 @@ InterpretResult run(VM* vm) {
                         pop(vm);
                         ObjString* string = AS_STRING(pop(vm));
                         if (index < 0 || index > string->length) {
-                            throwNativeException(vm, "clox.std.lang.IndexOutOfBoundsException", "String index is out of bound: %d.", index);
+                            THROW_NATIVE_EXCEPTION("clox.std.lang.IndexOutOfBoundsException", "String index is out of bound: %d.", index);
                         }
                         else {
                             char chars[2] = { string->chars[index], '\0' };
@@ -916,14 +1390,14 @@ InterpretResult run(VM* vm) {
                         pop(vm);
                         ObjArray* array = AS_ARRAY(pop(vm));
                         if (index < 0 || index > array->elements.count) {
-                            throwNativeException(vm, "clox.std.lang.IndexOutOfBoundsException", "Array index is out of bound: %d.", index);
+                            THROW_NATIVE_EXCEPTION("clox.std.lang.IndexOutOfBoundsException", "Array index is out of bound: %d.", index);
                         }
                         else {
                             Value element = array->elements.values[index];
                             push(vm, element);
                         }
                     }
-                    else OVERLOAD_OP([], 1);
+                    else OVERLOAD_OP(OPERATOR_GET_SUBSCRIPT, 1);
                 }
                 else if (IS_DICTIONARY(peek(vm, 1))) {
                     Value key = pop(vm);
@@ -932,124 +1406,203 @@ InterpretResult run(VM* vm) {
                     if (dictGet(dictionary, key, &value)) push(vm, value);
                     else push(vm, NIL_VAL);
                 }
-                else OVERLOAD_OP([], 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_GET_SUBSCRIPT, 1);
+                NEXT;
             }
-            case OP_GET_SUPER: {
+            CASE(OP_GET_SUPER): {
                 ObjString* name = READ_STRING();
                 ObjClass* klass = AS_CLASS(pop(vm));
+                STORE_FRAME();
 
                 if (!bindMethod(vm, klass->superclass, name)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                NEXT;
             }
-            case OP_EQUAL: {
-                if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(BOOL_VAL, == );
+            CASE(OP_EQUAL): {
+                if (BOTH_INT()) {
+                    QUICKEN(OP_EQUAL_INT);
+                    BINARY_INT_OP(BOOL_VAL, == );
+                }
+                else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(BOOL_VAL, == );
                 else {
-                    ObjString* op = copyStringPerma(vm, "==", 2);
-                    if (!invokeOperator(vm, op, 1)) {
+                    STORE_FRAME();
+                    if (!invokeOperator(vm, OPERATOR_EQUAL, 1)) {
                         Value b = pop(vm);
                         Value a = pop(vm);
                         push(vm, BOOL_VAL(a == b));
                     }
                     else LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_GREATER:
-                if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(BOOL_VAL, > );
-                else OVERLOAD_OP(> , 1);
-                break;
-            case OP_LESS:
-                if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(BOOL_VAL, < );
-                else OVERLOAD_OP(< , 1);
-                break;
-            case OP_ADD: {
+            CASE(OP_GREATER):
+                if (BOTH_INT()) {
+                    QUICKEN(OP_GREATER_INT);
+                    BINARY_INT_OP(BOOL_VAL, > );
+                }
+                else if (BOTH_FLOAT()) {
+                    QUICKEN(OP_GREATER_FLOAT);
+                    BINARY_FLOAT_OP(BOOL_VAL, > );
+                }
+                else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(BOOL_VAL, > );
+                else OVERLOAD_OP(OPERATOR_GREATER, 1);
+                NEXT;
+            CASE(OP_LESS):
+                if (BOTH_INT()) {
+                    QUICKEN(OP_LESS_INT);
+                    BINARY_INT_OP(BOOL_VAL, < );
+                }
+                else if (BOTH_FLOAT()) {
+                    QUICKEN(OP_LESS_FLOAT);
+                    BINARY_FLOAT_OP(BOOL_VAL, < );
+                }
+                else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(BOOL_VAL, < );
+                else OVERLOAD_OP(OPERATOR_LESS, 1);
+                NEXT;
+            CASE(OP_ADD): {
                 if (IS_STRING(peek(vm, 0)) && IS_STRING(peek(vm, 1))) {
+                    QUICKEN(OP_ADD_STRING);
                     concatenate(vm);
                 }
-                else if (IS_INT(peek(vm, 0)) && IS_INT(peek(vm, 1))) BINARY_INT_OP(INT_VAL, +);
+                else if (BOTH_INT()) {
+                    QUICKEN(OP_ADD_INT);
+                    BINARY_INT_OP(INT_VAL, +);
+                }
+                else if (BOTH_FLOAT()) {
+                    QUICKEN(OP_ADD_FLOAT);
+                    BINARY_FLOAT_OP(FLOAT_VAL, +);
+                }
                 else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(NUMBER_VAL, +);
-                else OVERLOAD_OP(+, 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_ADD, 1);
+                NEXT;
             }
-            case OP_SUBTRACT: {
-                if (IS_INT(peek(vm, 0)) && IS_INT(peek(vm, 1))) BINARY_INT_OP(INT_VAL, -);
+            CASE(OP_SUBTRACT): {
+                if (BOTH_INT()) {
+                    QUICKEN(OP_SUBTRACT_INT);
+                    BINARY_INT_OP(INT_VAL, -);
+                }
+                else if (BOTH_FLOAT()) {
+                    QUICKEN(OP_SUBTRACT_FLOAT);
+                    BINARY_FLOAT_OP(FLOAT_VAL, -);
+                }
                 else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(NUMBER_VAL, -);
-                else OVERLOAD_OP(-, 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_SUBTRACT, 1);
+                NEXT;
             }
-            case OP_MULTIPLY: {
+            CASE(OP_MULTIPLY): {
                 if (IS_INT(peek(vm, 0)) && IS_INT(peek(vm, 1))) BINARY_INT_OP(INT_VAL, *);
                 else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(NUMBER_VAL, *);
-                else OVERLOAD_OP(*, 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_MULTIPLY, 1);
+                NEXT;
             }
-            case OP_DIVIDE:
+            CASE(OP_DIVIDE):
                 if (IS_INT(peek(vm, 0)) && AS_INT(peek(vm, 0)) == 0) {
-                    throwNativeException(vm, "clox.std.lang.ArithmeticException", "It is illegal to divide an integer by 0.");
+                    THROW_NATIVE_EXCEPTION("clox.std.lang.ArithmeticException", "It is illegal to divide an integer by 0.");
                 }
                 else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) BINARY_NUMBER_OP(NUMBER_VAL, / );
-                else OVERLOAD_OP(/, 1);
-                break;
-            case OP_MODULO: {
+                else OVERLOAD_OP(OPERATOR_DIVIDE, 1);
+                NEXT;
+            CASE(OP_MODULO): {
                 if (IS_INT(peek(vm, 0)) && IS_INT(peek(vm, 1))) BINARY_INT_OP(INT_VAL, %);
                 else if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) {
                     double b = AS_NUMBER(pop(vm));
                     double a = AS_NUMBER(pop(vm));
                     push(vm, NUMBER_VAL(fmod(a, b)));
                 }
-                else OVERLOAD_OP(%, 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_MODULO, 1);
+                NEXT;
             }
-            case OP_NIL_COALESCING: {
+            CASE(OP_NIL_COALESCING): {
                 Value b = pop(vm);
                 Value a = pop(vm);
                 push(vm, IS_NIL(a) ? b : a);
-                break;
+                NEXT;
             }
-            case OP_ELVIS: {
+            CASE(OP_ELVIS): {
                 Value b = pop(vm);
                 Value a = pop(vm);
                 push(vm, isFalsey(a) ? b : a);
-                break;
+                NEXT;
             }
-            case OP_NOT:
+            CASE(OP_NOT):
                 push(vm, BOOL_VAL(isFalsey(pop(vm))));
-                break;
-            case OP_NEGATE:
+                NEXT;
+            CASE(OP_NEGATE):
                 if (!IS_NUMBER(peek(vm, 0))) {
-                    throwNativeException(vm, "clox.std.lang.IllegalArgumentException", "Operand must be a number for negate operator.");
+                    THROW_NATIVE_EXCEPTION("clox.std.lang.IllegalArgumentException", "Operand must be a number for negate operator.");
                 }
                 else if (IS_INT(peek(vm, 0))) push(vm, INT_VAL(-AS_INT(pop(vm))));
                 else push(vm, NUMBER_VAL(-AS_NUMBER(pop(vm))));
-                break;
-            case OP_JUMP: {
+                NEXT;
+            CASE(OP_JUMP): {
                 uint16_t offset = READ_SHORT();
-                frame->ip += offset;
-                break;
+                ip += offset;
+                NEXT;
             }
-            case OP_JUMP_IF_FALSE: {
+            CASE(OP_JUMP_IF_FALSE): {
                 uint16_t offset = READ_SHORT();
-                if (isFalsey(peek(vm, 0))) frame->ip += offset;
-                break;
+                if (isFalsey(peek(vm, 0))) ip += offset;
+                NEXT;
             }
-            case OP_LOOP: {
+            CASE(OP_POP_JUMP_IF_FALSE): {
                 uint16_t offset = READ_SHORT();
-                frame->ip -= offset;
-                break;
+                if (isFalsey(pop(vm))) ip += offset;
+                NEXT;
             }
-            case OP_CALL: {
+            CASE(OP_INTERPOLATE): {
+                uint8_t count = READ_BYTE();
+                if (!interpolate(vm, count)) {
+                    THROW_NATIVE_EXCEPTION("clox.std.lang.IllegalArgumentException", "String interpolation expects every part to be converted to string.");
+                }
+                NEXT;
+            }
+            CASE(OP_FOR_PREP): {
+                uint16_t offset = READ_SHORT();
+                if (isNativeIterable(vm, peek(vm, 0))) {
+                    push(vm, INT_VAL(-1));
+                    ip += offset;
+                }
+                NEXT;
+            }
+            CASE(OP_FOR_ITER): {
+                uint8_t slot = READ_BYTE();
+                uint16_t bodyOffset = READ_SHORT();
+                uint8_t* body = ip + bodyOffset;
+                uint16_t exitOffset = READ_SHORT();
+                if (IS_INT(frame->slots[slot + 1])) {
+                    if (iterateNative(vm, &frame->slots[slot])) ip = body;
+                    else ip += exitOffset;
+                }
+                NEXT;
+            }
+            CASE(OP_LOOP): {
+                uint16_t offset = READ_SHORT();
+                ip -= offset;
+                NEXT;
+            }
+            CASE(OP_TAIL_CALL): {
+                uint8_t argCount = *ip;
+                Value callee = peek(vm, argCount);
+                if (IS_CLOSURE(callee) && canReuseFrame(frame, (int)(ip - chunk->code - 1), AS_CLOSURE(callee), argCount)) {
+                    reuseCallFrame(vm, frame, AS_CLOSURE(callee), argCount);
+                    LOAD_FRAME();
+                    NEXT;
+                }
+            }
+            // falls through
+            CASE(OP_CALL): {
                 uint8_t argCount = READ_BYTE();
+                STORE_FRAME();
                 if (!callValue(vm, peek(vm, argCount), argCount)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_OPTIONAL_CALL: {
+            CASE(OP_OPTIONAL_CALL): {
                 uint8_t argCount = READ_BYTE();
+                STORE_FRAME();
                 Value callee = peek(vm, argCount);
                 if (IS_NIL(callee)) {
                     vm->stackTop -= (size_t)argCount + 1;
@@ -1059,61 +1612,75 @@ InterpretResult run(VM* vm) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_INVOKE: {
-                ObjString* method = READ_STRING();
+            CASE(OP_TO_STRING):
+                if (!IS_OBJ(peek(vm, 0)) || IS_STRING(peek(vm, 0))) {
+                    ip += 4;
+                    NEXT;
+                }
+                // falls through
+            CASE(OP_INVOKE): {
+                uint8_t byte = READ_BYTE();
+                ObjString* method = AS_STRING(identifiers[byte]);
                 uint8_t argCount = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
+                STORE_FRAME();
                 Value receiver = peek(vm, argCount);
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_INVOKE, __onInvoke__) && hasMethod(vm, getObjClass(vm, receiver), method)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_INVOKE) && hasMethod(vm, getObjClass(vm, receiver), method)) {
                     interceptOnInvoke(vm, receiver, method, argCount);
                     LOAD_FRAME();
                 }
 
-                if (!invoke(vm, method, argCount)) {
+                if (!invokeFromCache(vm, chunk, byte, inlineCache, argCount)) {
                     if (IS_NIL(receiver)) {
-                        throwNativeException(vm, "clox.std.lang.MethodNotFoundException", "Calling undefined method '%s' on nil.", method->chars);
+                        THROW_NATIVE_EXCEPTION("clox.std.lang.MethodNotFoundException", "Calling undefined method '%s' on nil.", method->chars);
                     }
                     else return INTERPRET_RUNTIME_ERROR;
                 }
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_SUPER_INVOKE: {
-                ObjString* method = READ_STRING();
+            CASE(OP_SUPER_INVOKE): {
+                uint8_t byte = READ_BYTE();
                 uint8_t argCount = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
+                STORE_FRAME();
                 ObjClass* klass = AS_CLASS(pop(vm));
 
-                if (!invokeFromClass(vm, klass, method, argCount)) {
+                if (!invokeSuperFromCache(vm, klass, chunk, byte, inlineCache, argCount)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_OPTIONAL_INVOKE: {
-                ObjString* method = READ_STRING();
+            CASE(OP_OPTIONAL_INVOKE): {
+                uint8_t byte = READ_BYTE();
+                ObjString* method = AS_STRING(identifiers[byte]);
                 uint8_t argCount = READ_BYTE();
+                InlineCache* inlineCache = READ_INLINE_CACHE();
+                STORE_FRAME();
                 Value receiver = peek(vm, argCount);
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_INVOKE, __onInvoke__) && hasMethod(vm, getObjClass(vm, receiver), method)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_INVOKE) && hasMethod(vm, getObjClass(vm, receiver), method)) {
                     interceptOnInvoke(vm, receiver, method, argCount);
                     LOAD_FRAME();
                 }
 
-                if (!invoke(vm, method, argCount)) {
+                if (!invokeFromCache(vm, chunk, byte, inlineCache, argCount)) {
                     if (IS_NIL(receiver)) {
                         vm->stackTop -= (size_t)argCount + 1;
                         push(vm, NIL_VAL);
                     }
                     else {
-                        throwNativeException(vm, "clox.std.lang.MethodNotFoundException", "Calling undefined method '%s' on instance of %s.", method->chars, getObjClass(vm, receiver)->fullName->chars);
+                        THROW_NATIVE_EXCEPTION("clox.std.lang.MethodNotFoundException", "Calling undefined method '%s' on instance of %s.", method->chars, getObjClass(vm, receiver)->fullName->chars);
                     }
                 }
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_CLOSURE: {
+            CASE(OP_CLOSURE): {
                 ObjFunction* function = AS_FUNCTION(READ_IDENTIFIER());
                 ObjClosure* closure = newClosure(vm, function);
                 push(vm, OBJ_VAL(closure));
@@ -1126,26 +1693,27 @@ InterpretResult run(VM* vm) {
                     else {
                         closure->upvalues[i] = frame->closure->upvalues[index];
                     }
+                    PROCESS_WRITE_BARRIER((Obj*)closure, OBJ_VAL(closure->upvalues[i]));
                 }
-                break;
+                NEXT;
             }
-            case OP_CLOSE_UPVALUE:
+            CASE(OP_CLOSE_UPVALUE):
                 closeUpvalues(vm, vm->stackTop - 1);
                 pop(vm);
-                break;
-            case OP_CLASS: {
+                NEXT;
+            CASE(OP_CLASS): {
                 ObjString* className = READ_STRING();
                 push(vm, OBJ_VAL(newClass(vm, className, OBJ_INSTANCE)));
                 tableSet(vm, &vm->currentNamespace->values, className, peek(vm, 0));
-                break;
+                NEXT;
             }
-            case OP_TRAIT: {
+            CASE(OP_TRAIT): {
                 ObjString* traitName = READ_STRING();
                 push(vm, OBJ_VAL(createTrait(vm, traitName)));
                 tableSet(vm, &vm->currentNamespace->values, traitName, peek(vm, 0));
-                break;
+                NEXT;
             }
-            case OP_ANONYMOUS: {
+            CASE(OP_ANONYMOUS): {
                 uint8_t behaviorType = READ_BYTE();
                 if (behaviorType == BEHAVIOR_TRAIT) {
                     push(vm, OBJ_VAL(createTrait(vm, NULL)));
@@ -1153,9 +1721,10 @@ InterpretResult run(VM* vm) {
                 else {
                     push(vm, OBJ_VAL(createClass(vm, NULL, vm->objectClass->obj.klass, behaviorType)));
                 }
-                break;
+                NEXT;
             }
-            case OP_INHERIT: {
+            CASE(OP_INHERIT): {
+                STORE_FRAME();
                 ObjClass* klass = AS_CLASS(peek(vm, 1));
                 if (klass->behaviorType == BEHAVIOR_CLASS) {
                     Value superclass = peek(vm, 0);
@@ -1166,30 +1735,33 @@ InterpretResult run(VM* vm) {
                 }
                 else RUNTIME_ERROR("Only class can inherit from another class.");
                 pop(vm);
-                break;
+                NEXT;
             }
-            case OP_IMPLEMENT: {
+            CASE(OP_IMPLEMENT): {
                 uint8_t behaviorCount = READ_BYTE();
+                STORE_FRAME();
                 ObjArray* traits = makeTraitArray(vm, behaviorCount);
                 if (traits == NULL) RUNTIME_ERROR("Only traits can be implemented by class or another trait.");
                 ObjClass* klass = AS_CLASS(peek(vm, 1));
                 implementTraits(vm, klass, &traits->elements);
                 pop(vm);
-                break;
+                NEXT;
             }
-            case OP_FIELD: {
+            CASE(OP_FIELD): {
                 ObjString* fieldName = READ_STRING();
                 bool isClassField = (bool)READ_BYTE();
+                STORE_FRAME();
                 defineField(vm, fieldName, isClassField);
-                break;
+                NEXT;
             }
-            case OP_METHOD: {
+            CASE(OP_METHOD): {
                 ObjString* methodName = READ_STRING();
                 bool isClassMethod = (bool)READ_BYTE();
+                STORE_FRAME();
                 defineMethod(vm, methodName, isClassMethod);
-                break;
+                NEXT;
             }
-            case OP_TYPE: {
+            CASE(OP_TYPE): {
                 ObjString* typeName = READ_STRING();
                 TypeInfo* typeInfo = typeTableGet(vm->typetab, typeName);
                 if (!IS_ALIAS_TYPE(typeInfo)) {
@@ -1198,54 +1770,57 @@ InterpretResult run(VM* vm) {
                 
                 push(vm, OBJ_VAL(newType(vm, typeName, typeInfo)));
                 tableSet(vm, &vm->currentNamespace->values, typeName, peek(vm, 0));
-                break;
+                NEXT;
             }
-            case OP_ARRAY: {
+            CASE(OP_ARRAY): {
                 uint8_t elementCount = READ_BYTE();
                 makeArray(vm, elementCount);
-                break;
+                NEXT;
             }
-            case OP_DICTIONARY: {
+            CASE(OP_DICTIONARY): {
                 uint8_t entryCount = READ_BYTE();
                 makeDictionary(vm, entryCount);
-                break;
+                NEXT;
             }
-            case OP_RANGE: {
+            CASE(OP_RANGE): {
                 if (IS_INT(peek(vm, 0)) && IS_INT(peek(vm, 1))) {
                     int b = AS_INT(pop(vm));
                     int a = AS_INT(pop(vm));
                     push(vm, OBJ_VAL(newRange(vm, a, b)));
                 }
-                else OVERLOAD_OP(.., 1);
-                break;
+                else OVERLOAD_OP(OPERATOR_RANGE, 1);
+                NEXT;
             }
-            case OP_REQUIRE: {
+            CASE(OP_REQUIRE): {
+                STORE_FRAME();
                 Value filePath = pop(vm);
                 Value value;
                 if (!IS_STRING(filePath)) {
-                    throwNativeException(vm, "clox.std.lang.IllegalArgumentException", "Required file path must be a string.");
-                    break;
+                    THROW_NATIVE_EXCEPTION("clox.std.lang.IllegalArgumentException", "Required file path must be a string.");
+                    NEXT;
                 }
                 else if (tableGet(&vm->modules, AS_STRING(filePath), &value)) {
-                    break;
+                    NEXT;
                 }
 
-                loadModule(vm, AS_STRING(filePath));
+                loadModule(vm, AS_STRING(filePath), false);
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_NAMESPACE: {
+            CASE(OP_NAMESPACE): {
                 Value namespace = READ_IDENTIFIER();
                 push(vm, namespace);
-                break;
+                NEXT;
             }
-            case OP_DECLARE_NAMESPACE: {
+            CASE(OP_DECLARE_NAMESPACE): {
                 uint8_t namespaceDepth = READ_BYTE();
+                STORE_FRAME();
                 vm->currentNamespace = declareNamespace(vm, namespaceDepth);
-                break;
+                NEXT;
             }
-            case OP_GET_NAMESPACE: {
+            CASE(OP_GET_NAMESPACE): {
                 uint8_t namespaceDepth = READ_BYTE();
+                STORE_FRAME();
                 Value value = usingNamespace(vm, namespaceDepth);
                 ObjNamespace* enclosingNamespace = AS_NAMESPACE(pop(vm));
                 ObjString* shortName = AS_STRING(pop(vm));
@@ -1254,7 +1829,7 @@ InterpretResult run(VM* vm) {
                 else {
                     ObjString* filePath = locateSourceFile(vm, shortName, enclosingNamespace);
                     if (sourceFileExists(filePath)) {
-                        loadModule(vm, filePath);
+                        loadModule(vm, filePath, false);
                         if (tableGet(&enclosingNamespace->values, shortName, &value)) {
                             pop(vm);
                             push(vm, value);
@@ -1264,7 +1839,7 @@ InterpretResult run(VM* vm) {
                     else {
                         ObjString* directoryPath = locateSourceDirectory(vm, shortName, enclosingNamespace);
                         if (!sourceDirectoryExists(directoryPath)) {
-                            throwNativeException(vm, "clox.std.io.FileNotFoundException", "Failed to load source file for %s", filePath->chars);
+                            THROW_NATIVE_EXCEPTION("clox.std.io.FileNotFoundException", "Failed to load source file for %s", filePath->chars);
                         }
                         else if (!tableGet(&enclosingNamespace->values, shortName, &value)) {
                             ObjNamespace* namespace = newNamespace(vm, shortName, enclosingNamespace);
@@ -1273,9 +1848,9 @@ InterpretResult run(VM* vm) {
                         }
                     }
                 }
-                break;
+                NEXT;
             }
-            case OP_USING_NAMESPACE: {
+            CASE(OP_USING_NAMESPACE): {
                 Value value = pop(vm);
                 if (IS_NIL(value)) RUNTIME_ERROR("Undefined class/trait/namespace specified.");
                 ObjString* alias = READ_STRING();
@@ -1311,10 +1886,10 @@ InterpretResult run(VM* vm) {
                     }
                 }
                 else RUNTIME_ERROR("Only classes, traits and namespaces may be imported.");
-                break;
+                NEXT;
             }
-            case OP_THROW: {
-                ObjArray* stackTrace = getStackTrace(vm);
+            CASE(OP_THROW): {
+                STORE_FRAME();
                 Value value = peek(vm, 0);
 
                 if (!isObjInstanceOf(vm, value, vm->exceptionClass)) {
@@ -1322,11 +1897,11 @@ InterpretResult run(VM* vm) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 ObjException* exception = AS_EXCEPTION(value);
-                exception->stacktrace = stackTrace;
+                captureStackTrace(vm, exception);
 
                 ObjString* name = frame->closure->function->name;
                 Value receiver = peek(vm, frame->closure->function->arity + 1);
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_THROW, __onThrow__) && hasInterceptableMethod(vm, receiver, name)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_THROW) && hasInterceptableMethod(vm, receiver, name)) {
                     pop(vm);
                     interceptOnThrow(vm, receiver, name, OBJ_VAL(exception));
                     LOAD_FRAME();
@@ -1334,41 +1909,21 @@ InterpretResult run(VM* vm) {
 
                 if (propagateException(vm, false)) {
                     LOAD_FRAME();
-                    break;
+                    NEXT;
                 }
                 else if (vm->runningGenerator != NULL) vm->runningGenerator->state = GENERATOR_THROW;
                 return INTERPRET_RUNTIME_ERROR;
             }
-            case OP_TRY: {
-                uint8_t byte = READ_BYTE();
-                uint16_t handlerAddress = READ_SHORT();
-                uint16_t finallyAddress = READ_SHORT();
-                Value value;
-                if (!loadGlobal(vm, &frame->closure->function->chunk, byte, &value)) {
-                    ObjString* exceptionClass = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
-                    RUNTIME_ERROR("Undefined class %s specified as exception type.", exceptionClass->chars);
-                }
-
-                ObjClass* klass = AS_CLASS(value);
-                if (!isClassExtendingSuperclass(klass, vm->exceptionClass)) {
-                    ObjString* exceptionClass = AS_STRING(frame->closure->function->chunk.identifiers.values[byte]);
-                    RUNTIME_ERROR("Expect subclass of clox.std.lang.Exception, but got Class %s.", exceptionClass->chars);
-                }
-                pushExceptionHandler(vm, klass, handlerAddress, finallyAddress);
-                break;
-            }
-            case OP_CATCH:
-                frame->handlerCount--;
-                break;
-            case OP_FINALLY: {
-                frame->handlerCount--;
+            CASE(OP_FINALLY): {
+                STORE_FRAME();
+                pop(vm);
                 if (propagateException(vm, false)) {
                     LOAD_FRAME();
-                    break;
+                    NEXT;
                 }
                 return INTERPRET_RUNTIME_ERROR;
             }
-            case OP_RETURN: {
+            CASE(OP_RETURN): {
                 Value result = pop(vm);
                 ObjString* name = frame->closure->function->name;
                 Value receiver = peek(vm, frame->closure->function->arity);
@@ -1387,15 +1942,16 @@ InterpretResult run(VM* vm) {
                 if (!frame->closure->function->isGenerator && !frame->closure->function->isAsync) vm->stackTop = frame->slots;
                 push(vm, result);
                 if (vm->apiStackDepth > 0) return INTERPRET_OK;
+                if (vm->retiredStacks != NULL) freeRetiredStacks(vm);
                 LOAD_FRAME();
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_RETURN, __onReturn__) && hasInterceptableMethod(vm, receiver, name)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_RETURN) && hasInterceptableMethod(vm, receiver, name)) {
                     interceptOnReturn(vm, receiver, name, result);
                     LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_RETURN_NONLOCAL: {
+            CASE(OP_RETURN_NONLOCAL): {
                 Value result = pop(vm);
                 uint8_t depth = READ_BYTE();
                 ObjString* name = frame->closure->function->name;
@@ -1418,19 +1974,20 @@ InterpretResult run(VM* vm) {
                 if (vm->apiStackDepth > 0) return INTERPRET_OK;
                 LOAD_FRAME();
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_RETURN, __onReturn__) && hasInterceptableMethod(vm, receiver, name)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_RETURN) && hasInterceptableMethod(vm, receiver, name)) {
                     interceptOnReturn(vm, receiver, name, result);
                     LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_YIELD: {
+            CASE(OP_YIELD): {
+                STORE_FRAME();
                 Value result = peek(vm, 0);
                 ObjString* name = frame->closure->function->name;
                 Value receiver = vm->runningGenerator->frame->slots[0];
                 saveGeneratorFrame(vm, vm->runningGenerator, frame, result);
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_YIELD, __onYield__) && hasInterceptableMethod(vm, receiver, name)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_YIELD) && hasInterceptableMethod(vm, receiver, name)) {
                     interceptOnYield(vm, receiver, name, result);
                     LOAD_FRAME();
                 }
@@ -1438,9 +1995,10 @@ InterpretResult run(VM* vm) {
                 vm->frameCount--;
                 if (vm->apiStackDepth > 0) return INTERPRET_OK;
                 LOAD_FRAME();
-                break;
+                NEXT;
             }
-            case OP_YIELD_FROM: {
+            CASE(OP_YIELD_FROM): {
+                STORE_FRAME();
                 Value result = peek(vm, 0);
                 ObjString* name = frame->closure->function->name;
                 Value receiver = vm->runningGenerator->frame->slots[0];
@@ -1458,9 +2016,10 @@ InterpretResult run(VM* vm) {
                     if (vm->apiStackDepth > 0) return INTERPRET_OK;
                     LOAD_FRAME();
                 }
-                break;
+                NEXT;
             }
-            case OP_AWAIT: {
+            CASE(OP_AWAIT): {
+                STORE_FRAME();
                 Value result = peek(vm, 0);
                 ObjString* name = frame->closure->function->name;
                 Value receiver = vm->runningGenerator->frame->slots[0];
@@ -1470,7 +2029,7 @@ InterpretResult run(VM* vm) {
                 }
                 saveGeneratorFrame(vm, vm->runningGenerator, frame, result);
 
-                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_AWAIT, __onAwait__) && hasInterceptableMethod(vm, receiver, name)) {
+                if (CAN_INTERCEPT(receiver, INTERCEPTOR_ON_AWAIT) && hasInterceptableMethod(vm, receiver, name)) {
                     interceptOnAwait(vm, receiver, name, result);
                     LOAD_FRAME();
                 }
@@ -1478,25 +2037,125 @@ InterpretResult run(VM* vm) {
                 vm->frameCount--;
                 if (vm->apiStackDepth > 0) return INTERPRET_OK;
                 LOAD_FRAME();
-                break;
+                NEXT;
+            }
+            CASE(OP_ADD_INT):
+                if (!BOTH_INT()) {
+                    DEQUICKEN(OP_ADD);
+                    NEXT;
+                }
+                BINARY_INT_OP(INT_VAL, +);
+                NEXT;
+            CASE(OP_ADD_FLOAT):
+                if (!BOTH_FLOAT()) {
+                    DEQUICKEN(OP_ADD);
+                    NEXT;
+                }
+                BINARY_FLOAT_OP(FLOAT_VAL, +);
+                NEXT;
+            CASE(OP_ADD_STRING):
+                if (!(IS_STRING(peek(vm, 0)) && IS_STRING(peek(vm, 1)))) {
+                    DEQUICKEN(OP_ADD);
+                    NEXT;
+                }
+                concatenate(vm);
+                NEXT;
+            CASE(OP_SUBTRACT_INT):
+                if (!BOTH_INT()) {
+                    DEQUICKEN(OP_SUBTRACT);
+                    NEXT;
+                }
+                BINARY_INT_OP(INT_VAL, -);
+                NEXT;
+            CASE(OP_SUBTRACT_FLOAT):
+                if (!BOTH_FLOAT()) {
+                    DEQUICKEN(OP_SUBTRACT);
+                    NEXT;
+                }
+                BINARY_FLOAT_OP(FLOAT_VAL, -);
+                NEXT;
+            CASE(OP_GREATER_INT):
+                if (!BOTH_INT()) {
+                    DEQUICKEN(OP_GREATER);
+                    NEXT;
+                }
+                BINARY_INT_OP(BOOL_VAL, > );
+                NEXT;
+            CASE(OP_GREATER_FLOAT):
+                if (!BOTH_FLOAT()) {
+                    DEQUICKEN(OP_GREATER);
+                    NEXT;
+                }
+                BINARY_FLOAT_OP(BOOL_VAL, > );
+                NEXT;
+            CASE(OP_LESS_INT):
+                if (!BOTH_INT()) {
+                    DEQUICKEN(OP_LESS);
+                    NEXT;
+                }
+                BINARY_INT_OP(BOOL_VAL, < );
+                NEXT;
+            CASE(OP_LESS_FLOAT):
+                if (!BOTH_FLOAT()) {
+                    DEQUICKEN(OP_LESS);
+                    NEXT;
+                }
+                BINARY_FLOAT_OP(BOOL_VAL, < );
+                NEXT;
+            CASE(OP_EQUAL_INT):
+                if (!BOTH_INT()) {
+                    DEQUICKEN(OP_EQUAL);
+                    NEXT;
+                }
+                BINARY_INT_OP(BOOL_VAL, == );
+                NEXT;
+            CASE(OP_GET_SUBSCRIPT_ARRAY_INT): {
+                if (!IS_INT(peek(vm, 0)) || !IS_ARRAY(peek(vm, 1))) {
+                    DEQUICKEN(OP_GET_SUBSCRIPT);
+                    NEXT;
+                }
+
+                int index = AS_INT(peek(vm, 0));
+                ObjArray* array = AS_ARRAY(peek(vm, 1));
+                if (index < 0 || index >= array->elements.count) {
+                    DEQUICKEN(OP_GET_SUBSCRIPT);
+                    NEXT;
+                }
+                vm->stackTop -= 2;
+                push(vm, array->elements.values[index]);
+                NEXT;
             }
         }
     }
 
+#undef LOAD_FRAME
+#undef STORE_FRAME
 #undef READ_BYTE
 #undef READ_SHORT
 #undef READ_CONSTANT
 #undef READ_IDENTIFIER
 #undef READ_STRING
+#undef READ_INLINE_CACHE
+#undef TRACE_EXECUTION
+#undef DISPATCH
+#undef CASE
+#undef NEXT
 #undef BINARY_INT_OP
 #undef BINARY_NUMBER_OP
+#undef BINARY_FLOAT_OP
+#undef SITE_OFFSET
+#undef QUICKEN
+#undef DEQUICKEN
+#undef BOTH_INT
+#undef BOTH_FLOAT
 #undef CAN_INTERCEPT
 #undef OVERLOAD_OP
+#undef THROW_NATIVE_EXCEPTION
 #undef RUNTIME_ERROR
 }
 
 InterpretResult interpret(VM* vm, const char* source) {
-    ObjFunction* function = compile(vm, source);
+    ObjFunction* function = compileModule(vm, vm->currentModule->path, source, false);
     if (function == NULL) return INTERPRET_COMPILE_ERROR;
     push(vm, OBJ_VAL(function));
     ObjClosure* closure = newClosure(vm, function);
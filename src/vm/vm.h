@@ -9,8 +9,9 @@
 #include "value.h"
 #include "../compiler/compiler.h"
 
-#define FRAMES_MAX 64
-#define STACK_MAX (FRAMES_MAX * UINT8_COUNT)
+#define FRAMES_MIN 16
+#define FRAMES_MAX 1024
+#define STACK_SIZE(frameCapacity) ((frameCapacity) * UINT8_COUNT)
 
 #define ABORT_IFNULL(pointer, message, ...) \
     do {\
@@ -32,10 +33,14 @@ struct CallFrame {
     ObjClosure* closure;
     uint8_t* ip;
     Value* slots;
-    uint8_t handlerCount;
-    ExceptionHandler handlerStack[UINT4_MAX];
 };
 
+typedef struct RetiredStack {
+    CallFrame* frames;
+    Value* stack;
+    struct RetiredStack* next;
+} RetiredStack;
+
 typedef struct {
     const char* version;
     const char* script;
@@ -52,11 +57,21 @@ typedef struct {
     uint8_t flagUnusedVariable;
     uint8_t flagMutableVariable;
 
+    bool optimizeAst;
+    bool cacheBytecode;
+
+    int maxFrames;
+
+    const char* cachePath;
+    size_t cacheMaxSize;
+
     const char* gcType;
     size_t gcTotalHeapSize;
     size_t gcEdenHeapSize;
     size_t gcYoungHeapSize;
     size_t gcOldHeapSize;
+    int gcMaxPause;
+    int gcWorkerCount;
 } Configuration;
 
 struct VM {
@@ -93,10 +108,12 @@ struct VM {
     ObjNamespace* langNamespace;
     ObjNamespace* currentNamespace;
 
-    CallFrame frames[FRAMES_MAX];
+    CallFrame* frames;
     int frameCount;
-    Value stack[STACK_MAX];
+    int frameCapacity;
+    Value* stack;
     Value* stackTop;
+    RetiredStack* retiredStacks;
     int apiStackDepth;
     ObjGenerator* runningGenerator;
     uv_loop_t* eventLoop;
@@ -124,6 +141,8 @@ struct VM {
 
     ObjString* initString;
     ObjString* voidString;
+    ObjString* operatorStrings[OPERATOR_COUNT];
+    ObjString* interceptorStrings[INTERCEPTOR_COUNT];
     ObjModule* currentModule;
     ObjUpvalue* openUpvalues;
     uint64_t objectIndex;
@@ -133,7 +152,7 @@ static inline bool isFalsey(Value value) {
     return IS_NIL(value) || (IS_BOOL(value) && !AS_BOOL(value));
 }
 
-void initVM(VM* vm);
+void initVM(VM* vm, int optionCount, char* options[]);
 void freeVM(VM* vm);
 void push(VM* vm, Value value);
 Value pop(VM* vm);